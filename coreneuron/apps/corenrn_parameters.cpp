@@ -47,6 +47,10 @@ corenrn_parameters::corenrn_parameters()
     app.add_flag("--model-stats",
                  this->model_stats,
                  "Print number of instances of each mechanism and detailed memory stats.");
+    app.add_flag("--cost-profile",
+                 this->cost_profile,
+                 "Write the compute time, events and spikes of every cell group and cell to "
+                 "cost_profile.dat in outpath, usable as --cost-file.");
 
     auto sub_gpu = app.add_option_group("GPU", "Commands relative to GPU.");
     sub_gpu
@@ -94,6 +98,18 @@ corenrn_parameters::corenrn_parameters()
                      this->restorepath,
                      "Restore simulation from provided checkpoint directory.")
         ->check(CLI::ExistingDirectory);
+    sub_input->add_flag("--mmap-input",
+                        this->mmap_input,
+                        "Read the model data files through a read-only memory mapping.");
+    sub_input->add_flag("--prefetch-input",
+                        this->prefetch_input,
+                        "Read the data files of the next phase on a background I/O thread.");
+    sub_input
+        ->add_option("--prefetch-window",
+                     this->prefetch_window,
+                     "Maximum MB of data files read ahead and not parsed yet by --prefetch-input.",
+                     true)
+        ->check(CLI::Range(1, 1'000'000));
 
     auto sub_parallel = app.add_option_group("parallel", "Parallel processing options.");
     sub_parallel->add_flag("-c, --threading",
@@ -102,6 +118,43 @@ corenrn_parameters::corenrn_parameters()
     sub_parallel->add_flag("--skip-mpi-finalize",
                            this->skip_mpi_finalize,
                            "Do not call mpi finalize.");
+    sub_parallel->add_flag("--gap-nonblocking",
+                           this->gap_nonblocking,
+                           "Transfer gap junction voltages without blocking, overlapped with "
+                           "the rest of the time step.");
+    sub_parallel->add_flag("--thread-team",
+                           this->thread_team,
+                           "Run threads as a persistent team instead of a parallel region per "
+                           "job (requires --threading).");
+    sub_parallel->add_flag("--pin-threads",
+                           this->pin_threads,
+                           "Pin the thread team to the cores of the process affinity mask.");
+    sub_parallel->add_flag("--cost-balance",
+                           this->cost_balance,
+                           "Distribute cell groups over ranks and threads by their predicted "
+                           "cost instead of files.dat order.");
+    sub_parallel
+        ->add_option("--cost-file",
+                     this->cost_file,
+                     "Cost model for --cost-balance: compartment, mechanism and group costs.")
+        ->check(CLI::ExistingFile);
+    sub_parallel->add_flag("--cost-calibrate",
+                           this->cost_calibrate,
+                           "Time the mechanisms during the run and write the fitted cost model "
+                           "to cost_model.dat in outpath, usable as --cost-file.");
+    sub_parallel
+        ->add_option("--thread-balance",
+                     this->thread_balance,
+                     "Every N min delay intervals reassign cell groups to the thread team "
+                     "members by their measured compute time (0: off).",
+                     true)
+        ->check(CLI::Range(0, 1'000'000));
+    sub_parallel
+        ->add_option("--balance-threshold",
+                     this->balance_threshold,
+                     "Thread imbalance (max / mean - 1) above which --thread-balance reassigns.",
+                     true)
+        ->check(CLI::Range(0., 10.));
 
     auto sub_spike = app.add_option_group("spike", "Spike exchange options.");
     sub_spike
@@ -116,12 +169,36 @@ corenrn_parameters::corenrn_parameters()
     sub_spike->add_flag("--multisend",
                         this->multisend,
                         "Use Multisend spike exchange instead of Allgather.");
+    sub_spike->add_flag("--neighbor-exchange",
+                        this->neighbor_exchange,
+                        "Send spikes only to the ranks that need them instead of Allgather.");
+    sub_spike->add_flag("--hierarchical-exchange",
+                        this->hierarchical_exchange,
+                        "Gather spikes on one rank per node and Allgather only between nodes.");
     sub_spike
         ->add_option("--spkcompress",
                      this->spkcompress,
                      "Spike compression. Up to ARG are exchanged during MPI_Allgather.",
                      true)
         ->check(CLI::Range(0, 100'000));
+    sub_spike->add_flag("--varint-compress",
+                        this->varint_compress,
+                        "Spike compression with delta and varint encoding. Unlike --spkcompress "
+                        "it does not limit the min delay to 255 dt.");
+    sub_spike
+        ->add_option("--shm-exchange",
+                     this->shm_exchange,
+                     "Exchange spikes through shared memory when all ranks are on one node. Up to "
+                     "ARG spikes per rank are exchanged without MPI_Allgather.",
+                     true)
+        ->check(CLI::Range(0, 10'000'000));
+    sub_spike
+        ->add_option("--exchange-autotune",
+                     this->exchange_autotune,
+                     "Time ARG spike exchange intervals with each of Allgather and, if requested, "
+                     "--spkcompress and --multisend and use the fastest for the rest of the run.",
+                     true)
+        ->check(CLI::Range(0, 1'000'000));
     sub_spike->add_flag("--binqueue", this->binqueue, "Use bin queue.");
 
     auto sub_config = app.add_option_group("config", "Config options.");
@@ -147,6 +224,21 @@ corenrn_parameters::corenrn_parameters()
                      "Maximum integration interval (likely reduced by minimum NetCon delay).",
                      true)
         ->check(CLI::Range(0., 1e9));
+    sub_config->add_flag("--thread-arena",
+                         this->thread_arena,
+                         "Allocate the model data of every thread contiguously from an arena "
+                         "that is freed at once.");
+    sub_config->add_flag("--index-compression",
+                         this->index_compression,
+                         "Store node and NetCon index arrays as 16 bit where the values fit, "
+                         "CPU only.");
+    sub_config
+        ->add_option("--huge-pages",
+                     this->huge_pages,
+                     "Back large arrays with 2 MB pages: 0 off; 1 transparent huge pages through "
+                     "madvise; 2 hugetlbfs pool, falling back to 1.",
+                     true)
+        ->check(CLI::Range(0, 2));
     sub_config
         ->add_option("--report-buffer-size",
                      this->report_buff_size,
@@ -163,6 +255,21 @@ corenrn_parameters::corenrn_parameters()
     sub_output->add_option("--checkpoint",
                            this->checkpointpath,
                            "Enable checkpoint and specify directory to store related files.");
+    sub_output->add_flag("--checkpoint-compress",
+                         this->checkpoint_compress,
+                         "Write the arrays of the checkpoint files block compressed.");
+    sub_output->add_flag("--checkpoint-native",
+                         this->checkpoint_native,
+                         "Write the checkpoint in the in-memory data layout, which is faster but "
+                         "can only be restored with the same dataset, number of ranks and threads "
+                         "and permutation options.");
+    sub_output
+        ->add_option("--checkpoint-interval",
+                     this->checkpoint_interval,
+                     "Also write a native checkpoint in the background every interval of "
+                     "simulated time (ms), rounded up to a multiple of the min delay.",
+                     true)
+        ->check(CLI::Range(0., 1e9));
 
     app.add_flag("-v, --version", this->show_version, "Show version information and quit.");
 
@@ -241,12 +348,29 @@ std::ostream& operator<<(std::ostream& os, const corenrn_parameters& corenrn_par
        << "--threading=" << (corenrn_param.threading ? "true" : "false") << std::endl
        << "--skip_mpi_finalize=" << (corenrn_param.skip_mpi_finalize ? "true" : "false")
        << std::endl
+       << "--gap_nonblocking=" << (corenrn_param.gap_nonblocking ? "true" : "false")
+       << std::endl
+       << "--thread_team=" << (corenrn_param.thread_team ? "true" : "false") << std::endl
+       << "--pin_threads=" << (corenrn_param.pin_threads ? "true" : "false") << std::endl
+       << "--cost_balance=" << (corenrn_param.cost_balance ? "true" : "false") << std::endl
+       << "--cost_file=" << corenrn_param.cost_file << std::endl
+       << "--cost_calibrate=" << (corenrn_param.cost_calibrate ? "true" : "false") << std::endl
+       << "--thread_balance=" << corenrn_param.thread_balance << std::endl
+       << "--balance_threshold=" << corenrn_param.balance_threshold << std::endl
        << std::endl
        << "SPIKE EXCHANGE" << std::endl
        << "--ms_phases=" << corenrn_param.ms_phases << std::endl
        << "--ms_subintervals=" << corenrn_param.ms_subint << std::endl
        << "--multisend=" << (corenrn_param.multisend ? "true" : "false") << std::endl
+       << "--neighbor_exchange=" << (corenrn_param.neighbor_exchange ? "true" : "false")
+       << std::endl
+       << "--hierarchical_exchange=" << (corenrn_param.hierarchical_exchange ? "true" : "false")
+       << std::endl
        << "--spk_compress=" << corenrn_param.spkcompress << std::endl
+       << "--varint_compress=" << (corenrn_param.varint_compress ? "true" : "false")
+       << std::endl
+       << "--shm_exchange=" << corenrn_param.shm_exchange << std::endl
+       << "--exchange_autotune=" << corenrn_param.exchange_autotune << std::endl
        << "--binqueue=" << (corenrn_param.binqueue ? "true" : "false") << std::endl
        << std::endl
        << "CONFIGURATION" << std::endl
@@ -256,11 +380,24 @@ std::ostream& operator<<(std::ostream& os, const corenrn_parameters& corenrn_par
        << "--celsius=" << corenrn_param.celsius << std::endl
        << "--mindelay=" << corenrn_param.mindelay << std::endl
        << "--report-buffer-size=" << corenrn_param.report_buff_size << std::endl
+       << "--thread_arena=" << (corenrn_param.thread_arena ? "true" : "false") << std::endl
+       << "--index_compression=" << (corenrn_param.index_compression ? "true" : "false")
+       << std::endl
+       << "--huge_pages=" << corenrn_param.huge_pages << std::endl
+       << "--mmap_input=" << (corenrn_param.mmap_input ? "true" : "false") << std::endl
+       << "--prefetch_input=" << (corenrn_param.prefetch_input ? "true" : "false") << std::endl
+       << "--prefetch_window=" << corenrn_param.prefetch_window << std::endl
        << std::endl
        << "OUTPUT PARAMETERS" << std::endl
        << "--dt_io=" << corenrn_param.dt_io << std::endl
        << "--outpath=" << corenrn_param.outpath << std::endl
-       << "--checkpoint=" << corenrn_param.checkpointpath << std::endl;
+       << "--checkpoint=" << corenrn_param.checkpointpath << std::endl
+       << "--checkpoint_compress=" << (corenrn_param.checkpoint_compress ? "true" : "false")
+       << std::endl
+       << "--checkpoint_native=" << (corenrn_param.checkpoint_native ? "true" : "false")
+       << std::endl
+       << "--checkpoint_interval=" << corenrn_param.checkpoint_interval << std::endl
+       << "--cost_profile=" << (corenrn_param.cost_profile ? "true" : "false") << std::endl;
 
     return os;
 }
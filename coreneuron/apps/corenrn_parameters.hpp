@@ -50,6 +50,11 @@ struct corenrn_parameters_data {
     unsigned ms_phases = 2;                /// Number of multisend phases, 1 or 2
     unsigned ms_subint = 2;                /// Number of multisend interval. 1 or 2
     unsigned spkcompress = 0;              /// Spike Compression
+    unsigned shm_exchange = 0;  /// Spikes per rank of the shared memory spike exchange (0: off)
+    unsigned exchange_autotune = 0;  /// Exchanges per spike exchange method to time (0: off)
+    unsigned thread_balance = 0;  /// Min delay intervals between thread balance checks (0: off)
+    unsigned huge_pages = 0;  /// 2 MB pages for large arrays: 0 off, 1 madvise, 2 hugetlbfs
+    unsigned prefetch_window = 256;  /// MB of data files held ahead by --prefetch-input
     unsigned cell_interleave_permute = 0;  /// Cell interleaving permutation
     unsigned nwarp = 65536;  /// Number of warps to balance for cell_interleave_permute == 2
     unsigned num_gpus = 0;   /// Number of gpus to use per node
@@ -58,7 +63,15 @@ struct corenrn_parameters_data {
 
     bool mpi_enable = false;         /// Enable MPI flag.
     bool skip_mpi_finalize = false;  /// Skip MPI finalization
+    bool gap_nonblocking = false;    /// Overlap the gap junction transfer with the time step
+    bool thread_team = false;        /// Run thread jobs on a persistent thread team
+    bool pin_threads = false;        /// Pin the thread team to cores
+    bool cost_balance = false;       /// Distribute cell groups by their predicted cost
+    bool cost_calibrate = false;     /// Fit the cost model to the mechanism times of the run
     bool multisend = false;          /// Use Multisend spike exchange instead of Allgather.
+    bool neighbor_exchange = false;  /// Use sparse neighbor spike exchange instead of Allgather.
+    bool hierarchical_exchange = false;  /// Gather spikes on node leaders before Allgather.
+    bool varint_compress = false;  /// Exchange spikes delta and varint encoded.
     bool threading = false;          /// Enable pthread/openmp
     bool gpu = false;                /// Enable GPU computation.
     bool cuda_interface = false;     /// Enable CUDA interface (default is the OpenACC interface).
@@ -70,6 +83,22 @@ struct corenrn_parameters_data {
 
     bool model_stats = false;  /// Print mechanism counts and model size after initialization
 
+    bool cost_profile = false;  /// Write the per group and per cell cost profile of the run
+
+    bool thread_arena = false;  /// Allocate the model data of each NrnThread from one arena
+
+    bool index_compression = false;  /// Replace index arrays by 16 bit ones where they fit
+
+    bool mmap_input = false;  /// Read the model data files through a read-only memory mapping
+
+    bool prefetch_input = false;  /// Read the files of the next phase on a background thread
+
+    bool checkpoint_compress = false;  /// Write the checkpoint arrays block compressed
+
+    bool checkpoint_native = false;  /// Write the checkpoint in the in-memory layout
+
+    double checkpoint_interval = 0.;  /// Interval of the checkpoints written during the run
+
     verbose_level verbose{verbose_level::DEFAULT};  /// Verbosity-level
 
     double tstop = 100;        /// Stop time of simulation in msec
@@ -81,6 +110,7 @@ struct corenrn_parameters_data {
     double forwardskip = 0.;   /// Forward skip to TIME.
     double mindelay = 10.;     /// Maximum integration interval (likely reduced by minimum NetCon
                                /// delay).
+    double balance_threshold = 0.1;  /// Thread imbalance (max / mean - 1) that triggers rebalancing
 
     std::string patternstim;             /// Apply patternstim using the specified spike file.
     std::string datpath = ".";           /// Directory path where .dat files
@@ -88,6 +118,7 @@ struct corenrn_parameters_data {
     std::string filesdat = "files.dat";  /// Name of file containing list of gids dat files read in
     std::string restorepath;             /// Restore simulation from provided checkpoint directory.
     std::string reportfilepath;          /// Reports configuration file.
+    std::string cost_file;               /// Cost model of the cell groups for cost_balance.
     std::string checkpointpath;  /// Enable checkpoint and specify directory to store related files.
     std::string writeParametersFilepath;  /// Write parameters to this file
     std::string mpi_lib;                  /// Name of CoreNEURON MPI library to load dynamically.
@@ -17,12 +17,22 @@
 #include <dlfcn.h>
 #include <memory>
 #include <vector>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 #include "coreneuron/config/config.h"
 #include "coreneuron/utils/randoms/nrnran123.h"
 #include "coreneuron/nrnconf.h"
 #include "coreneuron/sim/fast_imem.hpp"
 #include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/sim/thread_balance.hpp"
+#include "coreneuron/sim/thread_placement.hpp"
+#include "coreneuron/utils/thread_arena.hpp"
+#include "coreneuron/utils/huge_pages.hpp"
+#include "coreneuron/mechanism/index_compression.hpp"
+#include "coreneuron/io/cost_profile.hpp"
+#include "coreneuron/io/group_cost.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/nrniv/nrniv_decl.h"
 #include "coreneuron/mechanism/register_mech.hpp"
@@ -40,6 +50,8 @@
 #include "coreneuron/utils/profile/profiler_interface.h"
 #include "coreneuron/network/partrans.hpp"
 #include "coreneuron/network/multisend.hpp"
+#include "coreneuron/network/neighbor_exchange.hpp"
+#include "coreneuron/network/netpar.hpp"
 #include "coreneuron/io/nrn_setup.hpp"
 #include "coreneuron/io/file_utils.hpp"
 #include "coreneuron/io/nrn2core_direct.h"
@@ -273,6 +285,17 @@ void nrn_init_and_load_data(int argc,
     n_multisend_interval = corenrn_param.ms_subint;
     use_phase2_ = (corenrn_param.ms_phases == 2) ? 1 : 0;
 
+    // When autotuning, multisend and compression are set up as candidates besides Allgather
+    // instead of replacing it. Neighbor exchange is only used when the uncompressed Allgather
+    // exchange is.
+    bool autotune_exchange = corenrn_param.mpi_enable && corenrn_param.exchange_autotune > 0;
+    bool allgather_exchange = autotune_exchange ||
+                              (!use_multisend_ && corenrn_param.spkcompress == 0);
+    use_neighbor_exchange_ = allgather_exchange && !corenrn_param.varint_compress &&
+                             corenrn_param.neighbor_exchange;
+
+    nrn_huge_pages_init(corenrn_param.huge_pages);
+
     // reading *.dat files and setting up the data structures, setting mindelay
     nrn_setup(filesdat.c_str(),
               is_mapping_needed,
@@ -285,7 +308,65 @@ void nrn_init_and_load_data(int argc,
     // Allgather spike compression and  bin queuing.
     nrn_use_bin_queue_ = corenrn_param.binqueue;
     int spkcompress = corenrn_param.spkcompress;
-    nrnmpi_spike_compress(spkcompress, (spkcompress ? true : false), use_multisend_);
+    nrnmpi_spike_compress(spkcompress,
+                          (spkcompress ? true : false),
+                          autotune_exchange ? 0 : use_multisend_);
+
+#if NRNMPI
+    // varint compression replaces the uncompressed Allgather
+    if (corenrn_param.mpi_enable && corenrn_param.varint_compress && allgather_exchange) {
+        nrn_spike_varint_compress(true);
+    }
+    // shared memory and hierarchical exchange replace MPI_Allgather, not the other exchange
+    // methods. If both are requested, shared memory is used for single node runs.
+    bool allgather_variants = corenrn_param.mpi_enable && allgather_exchange &&
+                              !corenrn_param.varint_compress && !use_neighbor_exchange_;
+    bool shm = false;
+    if (allgather_variants && corenrn_param.shm_exchange) {
+        shm = nrnmpi_shm_spike_init(corenrn_param.shm_exchange);
+        if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+            printf(shm ? " Shared memory spike exchange enabled\n"
+                       : " Notice: shared memory spike exchange requires all ranks on one node\n");
+        }
+    }
+    if (allgather_variants && corenrn_param.hierarchical_exchange) {
+        int nnode = nrnmpi_spike_exchange_hierarchical_init();
+        if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+            printf(" Hierarchical spike exchange between %d nodes\n", nnode);
+        }
+    }
+    if (autotune_exchange) {
+        nrn_spike_exchange_autotune(corenrn_param.exchange_autotune);
+    }
+#endif
+
+    // where the NrnThread data ended up, see nrn_thread_team_init
+    if (corenrn_param.threading) {
+        nrn_thread_placement_report();
+    }
+    // nrn_fixed_step_group_gap uses its own OpenMP parallel region
+    if (nrn_have_gaps && nrn_thread_team_active() && nrnmpi_myid == 0 &&
+        !corenrn_param.is_quiet()) {
+        printf(" Notice: with the thread team, gap junction models advance by single steps\n");
+    }
+    nrn_thread_arena_report();
+    nrn_huge_pages_report();
+    nrn_index_compression_report();
+
+    // measured (--thread-balance) balance over the team, starting from the predicted one
+    if (corenrn_param.thread_balance &&
+        !nrn_thread_balance_init(corenrn_param.thread_balance, corenrn_param.balance_threshold) &&
+        nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Notice: thread balancing requires the thread team and more cell groups than "
+               "threads\n");
+    }
+
+    if (corenrn_param.cost_profile) {
+        nrn_cost_profile_init();
+    }
+    if (corenrn_param.cost_calibrate) {
+        nrn_cost_calibrate_init();
+    }
 
     if (!corenrn_param.is_quiet()) {
         report_mem_usage("After nrn_setup ");
@@ -541,7 +622,9 @@ extern "C" int run_solve_core(int argc, char** argv) {
         reports_needs_finalize = !configs.empty();
     }
 
-    CheckPoints checkPoints{corenrn_param.checkpointpath, corenrn_param.restorepath};
+    CheckPoints checkPoints{corenrn_param.checkpointpath,
+                            corenrn_param.restorepath,
+                            corenrn_param.checkpoint_interval};
 
     // initializationa and loading functions moved to separate
     {
@@ -623,7 +706,19 @@ extern "C" int run_solve_core(int argc, char** argv) {
         /// Solver execution
         Instrumentor::start_profile();
         Instrumentor::phase_begin("simulation");
+        double solver_time = nrn_wtime();
+        // interval checkpoints are staged at min delay boundaries and written
+        // in the background while the simulation goes on
+        for (double tc = checkPoints.next_interval_time(t, delay); tc < tstop - 0.5 * dt;
+             tc = checkPoints.next_interval_time(tc, delay)) {
+            BBS_netpar_solve(tc);
+            Instrumentor::phase p("interval-checkpoint");
+            checkPoints.write_interval_checkpoint(nrn_threads, nrn_nthread);
+        }
         BBS_netpar_solve(corenrn_param.tstop);
+        if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+            printf("\nSolver Time : %g\n", nrn_wtime() - solver_time);
+        }
         Instrumentor::phase_end("simulation");
         Instrumentor::stop_profile();
 
@@ -639,6 +734,10 @@ extern "C" int run_solve_core(int argc, char** argv) {
         if (!corenrn_param.is_quiet()) {
             report_cell_stats();
         }
+#if NRNMPI
+        nrn_spike_varint_report();
+#endif
+        nrn_thread_balance_report();
 
         // prcellstate after end of solver
         call_prcellstate_for_prcellgid(corenrn_param.prcellgid, compute_gpu, 0);
@@ -649,6 +748,8 @@ extern "C" int run_solve_core(int argc, char** argv) {
         Instrumentor::phase p("output-spike");
         output_spikes(output_dir.c_str(), spikes_info);
     }
+    nrn_cost_profile_write(output_dir);
+    nrn_cost_calibrate_write(output_dir);
 
     // copy weights back to NEURON NetCon
     if (nrn2core_all_weights_return_) {
@@ -0,0 +1,145 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+/*
+Pack a per group dataset into dataset containers, see dataset_container.hpp.
+
+    coreneuron-pack-dataset <datpath> <outpath> [ncontainer]
+
+Group i of files.dat goes to container i % ncontainer (default 1), which with
+one container per rank matches the default round robin distribution of the
+groups, i.e. every rank then reads a single container.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "coreneuron/io/dataset_container.hpp"
+
+using namespace coreneuron;
+
+namespace {
+bool read_file(const std::string& filename, std::vector<char>& data) {
+    std::ifstream in(filename, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+    data.resize(in.tellg());
+    in.seekg(0);
+    return static_cast<bool>(in.read(data.data(), data.size()));
+}
+
+bool copy_file(const std::string& from, const std::string& to) {
+    std::vector<char> data;
+    if (!read_file(from, data)) {
+        return false;
+    }
+    std::ofstream out(to, std::ios::out | std::ios::binary | std::ios::trunc);
+    out.write(data.data(), data.size());
+    return static_cast<bool>(out);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "usage: " << argv[0] << " <datpath> <outpath> [ncontainer]" << std::endl;
+        return 1;
+    }
+    std::string datpath = argv[1];
+    std::string outpath = argv[2];
+    int ncontainer = argc == 4 ? atoi(argv[3]) : 1;
+    if (ncontainer < 1) {
+        std::cerr << "ncontainer must be positive" << std::endl;
+        return 1;
+    }
+    if (outpath == datpath) {
+        std::cerr << "outpath must differ from datpath" << std::endl;
+        return 1;
+    }
+
+    std::ifstream filesdat(datpath + "/files.dat");
+    std::string version;
+    int ngroup;
+    if (!(filesdat >> version >> ngroup)) {
+        std::cerr << "cannot read " << datpath << "/files.dat" << std::endl;
+        return 1;
+    }
+    bool have_gaps = ngroup == -1;
+    if (have_gaps && !(filesdat >> ngroup)) {
+        std::cerr << "cannot read " << datpath << "/files.dat" << std::endl;
+        return 1;
+    }
+    std::vector<int> gids(ngroup);
+    for (auto& gid: gids) {
+        if (!(filesdat >> gid)) {
+            std::cerr << "cannot read " << datpath << "/files.dat" << std::endl;
+            return 1;
+        }
+    }
+    ncontainer = std::min(ncontainer, std::max(ngroup, 1));
+
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<DatasetContainerWriter>> writers;
+    for (int k = 0; k < ncontainer; ++k) {
+        names.push_back("dataset_" + std::to_string(k) + ".cnt");
+        writers.emplace_back(new DatasetContainerWriter(outpath + "/" + names.back()));
+    }
+    std::size_t nfile = 0;
+    std::vector<char> data;
+    for (int i = 0; i < ngroup; ++i) {
+        for (const char* suffix: {"1", "2", "3", "gap"}) {
+            std::string filename = datpath + "/" + std::to_string(gids[i]) + "_" + suffix +
+                                   ".dat";
+            // phase 3 and gap files are optional
+            if (!read_file(filename, data)) {
+                if (nrn_dataset_phase_of(suffix) <= 2) {
+                    std::cerr << "cannot read " << filename << std::endl;
+                    return 1;
+                }
+                continue;
+            }
+            writers[i % ncontainer]->add(gids[i], nrn_dataset_phase_of(suffix), data);
+            ++nfile;
+        }
+    }
+    for (auto& w: writers) {
+        w->close();
+    }
+
+    std::ofstream out(outpath + "/files.dat");
+    out << version << "\n";
+    if (have_gaps) {
+        out << "-1\n";
+    }
+    out << ngroup << "\n";
+    for (int i = 0; i < ngroup; ++i) {
+        out << gids[i] << " " << i % ncontainer << "\n";
+    }
+    out << "containers " << ncontainer << "\n";
+    for (const auto& name: names) {
+        out << name << "\n";
+    }
+    if (!out) {
+        std::cerr << "cannot write " << outpath << "/files.dat" << std::endl;
+        return 1;
+    }
+
+    for (const char* name: {"bbcore_mech.dat", "globals.dat"}) {
+        if (!copy_file(datpath + "/" + name, outpath + "/" + name)) {
+            std::cerr << "warning: could not copy " << datpath << "/" << name << std::endl;
+        }
+    }
+    printf("Packed %zu files of %d groups into %d containers\n", nfile, ngroup, ncontainer);
+    return 0;
+}
@@ -0,0 +1,320 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "coreneuron/io/array_compression.hpp"
+#include "coreneuron/utils/nrn_assert.h"
+
+namespace coreneuron {
+namespace array_compression {
+namespace {
+constexpr int hash_bits = 14;
+constexpr std::uint32_t stored_as_is = std::uint32_t(1) << 31;
+constexpr std::size_t header_bytes = 8;
+
+inline std::uint32_t load32(const std::uint8_t* p) {
+    std::uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline void store32(std::uint8_t* p, std::uint32_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+inline std::uint32_t hash4(std::uint32_t v) {
+    return (v * 2654435761u) >> (32 - hash_bits);
+}
+
+// length beyond the 15 of the token nibble, in bytes of 255 and a remainder
+inline std::uint8_t* put_length(std::uint8_t* op, std::size_t len) {
+    for (; len >= 255; len -= 255) {
+        *op++ = 255;
+    }
+    *op++ = static_cast<std::uint8_t>(len);
+    return op;
+}
+
+inline bool get_length(const std::uint8_t*& ip, const std::uint8_t* iend, std::size_t& len) {
+    std::uint8_t b;
+    do {
+        if (ip >= iend) {
+            return false;
+        }
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+// a match length of 0 marks the last sequence, which only has literals
+std::uint8_t* put_sequence(std::uint8_t* op,
+                           const std::uint8_t* literals,
+                           std::size_t nliteral,
+                           std::size_t offset,
+                           std::size_t match) {
+    std::uint8_t* token = op++;
+    std::uint8_t t = static_cast<std::uint8_t>(std::min<std::size_t>(nliteral, 15) << 4);
+    if (nliteral >= 15) {
+        op = put_length(op, nliteral - 15);
+    }
+    memcpy(op, literals, nliteral);
+    op += nliteral;
+    if (match) {
+        *op++ = static_cast<std::uint8_t>(offset);
+        *op++ = static_cast<std::uint8_t>(offset >> 8);
+        std::size_t m = match - 4;
+        t |= static_cast<std::uint8_t>(std::min<std::size_t>(m, 15));
+        if (m >= 15) {
+            op = put_length(op, m - 15);
+        }
+    }
+    *token = t;
+    return op;
+}
+
+void forward(const std::uint8_t* in,
+             std::size_t n,
+             std::size_t item_size,
+             std::uint8_t how,
+             std::uint8_t* out) {
+    std::vector<std::uint8_t> deltas;
+    if (how & delta) {
+        deltas.resize(n);
+        std::uint32_t previous = 0;
+        for (std::size_t i = 0; i < n; i += 4) {
+            std::uint32_t v = load32(in + i);
+            store32(deltas.data() + i, v - previous);
+            previous = v;
+        }
+        in = deltas.data();
+    }
+    if (how & shuffle) {
+        std::size_t m = n / item_size;
+        for (std::size_t i = 0; i < m; ++i) {
+            for (std::size_t b = 0; b < item_size; ++b) {
+                out[b * m + i] = in[i * item_size + b];
+            }
+        }
+    } else {
+        memcpy(out, in, n);
+    }
+}
+
+void inverse(const std::uint8_t* in,
+             std::size_t n,
+             std::size_t item_size,
+             std::uint8_t how,
+             std::uint8_t* out) {
+    if (how & shuffle) {
+        std::size_t m = n / item_size;
+        for (std::size_t i = 0; i < m; ++i) {
+            for (std::size_t b = 0; b < item_size; ++b) {
+                out[i * item_size + b] = in[b * m + i];
+            }
+        }
+    } else {
+        memcpy(out, in, n);
+    }
+    if (how & delta) {
+        std::uint32_t previous = 0;
+        for (std::size_t i = 0; i < n; i += 4) {
+            previous += load32(out + i);
+            store32(out + i, previous);
+        }
+    }
+}
+}  // namespace
+
+std::size_t lz_compress(const std::uint8_t* src, std::size_t n, std::uint8_t* dst) {
+    std::uint8_t* op = dst;
+    std::size_t anchor = 0;
+    if (n >= 8) {
+        std::vector<std::int32_t> table(std::size_t(1) << hash_bits, -1);
+        // step faster through data that does not match, as LZ4 does
+        std::size_t misses = 0;
+        for (std::size_t i = 0; i + 4 <= n;) {
+            std::uint32_t seq = load32(src + i);
+            std::int32_t& slot = table[hash4(seq)];
+            std::int64_t ref = slot;
+            slot = static_cast<std::int32_t>(i);
+            if (ref >= 0 && i - ref <= 65535 && load32(src + ref) == seq) {
+                std::size_t len = 4;
+                while (i + len < n && src[ref + len] == src[i + len]) {
+                    ++len;
+                }
+                op = put_sequence(op, src + anchor, i - anchor, i - ref, len);
+                i += len;
+                anchor = i;
+                misses = 0;
+            } else {
+                i += 1 + (misses++ >> 6);
+            }
+        }
+    }
+    op = put_sequence(op, src + anchor, n - anchor, 0, 0);
+    return op - dst;
+}
+
+bool lz_decompress(const std::uint8_t* src, std::size_t nsrc, std::uint8_t* dst, std::size_t n) {
+    const std::uint8_t* ip = src;
+    const std::uint8_t* iend = src + nsrc;
+    std::uint8_t* op = dst;
+    std::uint8_t* oend = dst + n;
+    while (ip < iend) {
+        std::uint8_t t = *ip++;
+        std::size_t nliteral = t >> 4;
+        if (nliteral == 15 && !get_length(ip, iend, nliteral)) {
+            return false;
+        }
+        if (std::size_t(iend - ip) < nliteral || std::size_t(oend - op) < nliteral) {
+            return false;
+        }
+        memcpy(op, ip, nliteral);
+        ip += nliteral;
+        op += nliteral;
+        if (ip == iend) {
+            break;
+        }
+        if (iend - ip < 2) {
+            return false;
+        }
+        std::size_t offset = ip[0] | (std::size_t(ip[1]) << 8);
+        ip += 2;
+        std::size_t match = t & 15;
+        if (match == 15 && !get_length(ip, iend, match)) {
+            return false;
+        }
+        match += 4;
+        if (offset == 0 || offset > std::size_t(op - dst) || std::size_t(oend - op) < match) {
+            return false;
+        }
+        const std::uint8_t* m = op - offset;
+        if (offset >= match) {
+            memcpy(op, m, match);
+        } else {
+            // overlapping match repeats the last offset bytes
+            for (std::size_t k = 0; k < match; ++k) {
+                op[k] = m[k];
+            }
+        }
+        op += match;
+    }
+    return op == oend;
+}
+
+std::vector<char> encode(const void* data,
+                         std::size_t nbytes,
+                         std::size_t item_size,
+                         bool delta_encode,
+                         bool parallel) {
+    nrn_assert(item_size > 0 && item_size < 256 && chunk_bytes % item_size == 0);
+    nrn_assert(nbytes % item_size == 0);
+    std::uint8_t how = 0;
+    if (item_size > 1) {
+        how |= shuffle;
+    }
+    if (delta_encode && item_size == 4) {
+        how |= delta;
+    }
+    auto src = static_cast<const std::uint8_t*>(data);
+    long nchunk = static_cast<long>((nbytes + chunk_bytes - 1) / chunk_bytes);
+    std::vector<std::vector<std::uint8_t>> chunks(nchunk);
+    std::vector<std::uint32_t> sizes(nchunk);
+
+    #pragma omp parallel for schedule(dynamic) if (parallel && nchunk > 1)
+    for (long c = 0; c < nchunk; ++c) {
+        const std::uint8_t* begin = src + c * chunk_bytes;
+        std::size_t n = std::min(chunk_bytes, nbytes - c * chunk_bytes);
+        std::vector<std::uint8_t> transformed(n);
+        forward(begin, n, item_size, how, transformed.data());
+        auto& out = chunks[c];
+        out.resize(lz_bound(n));
+        std::size_t nz = lz_compress(transformed.data(), n, out.data());
+        if (nz < n) {
+            out.resize(nz);
+            sizes[c] = static_cast<std::uint32_t>(nz);
+        } else {
+            out.assign(begin, begin + n);
+            sizes[c] = static_cast<std::uint32_t>(n) | stored_as_is;
+        }
+    }
+
+    std::size_t total = header_bytes + nchunk * sizeof(std::uint32_t);
+    for (const auto& chunk: chunks) {
+        total += chunk.size();
+    }
+    std::vector<char> z(total);
+    auto p = reinterpret_cast<std::uint8_t*>(z.data());
+    p[0] = how;
+    p[1] = static_cast<std::uint8_t>(item_size);
+    p[2] = p[3] = 0;
+    store32(p + 4, static_cast<std::uint32_t>(nchunk));
+    p += header_bytes;
+    for (auto size: sizes) {
+        store32(p, size);
+        p += sizeof(size);
+    }
+    for (const auto& chunk: chunks) {
+        std::copy(chunk.begin(), chunk.end(), p);
+        p += chunk.size();
+    }
+    return z;
+}
+
+bool decode(const char* z, std::size_t zbytes, void* data, std::size_t nbytes, bool parallel) {
+    auto p = reinterpret_cast<const std::uint8_t*>(z);
+    if (zbytes < header_bytes) {
+        return false;
+    }
+    std::uint8_t how = p[0];
+    std::size_t item_size = p[1];
+    long nchunk = load32(p + 4);
+    if (item_size == 0 || nbytes % item_size != 0 || chunk_bytes % item_size != 0 ||
+        std::size_t(nchunk) != (nbytes + chunk_bytes - 1) / chunk_bytes ||
+        zbytes < header_bytes + nchunk * sizeof(std::uint32_t)) {
+        return false;
+    }
+    std::vector<std::size_t> offsets(nchunk + 1);
+    offsets[0] = header_bytes + nchunk * sizeof(std::uint32_t);
+    for (long c = 0; c < nchunk; ++c) {
+        offsets[c + 1] = offsets[c] + (load32(p + header_bytes + c * 4) & ~stored_as_is);
+    }
+    if (offsets[nchunk] != zbytes) {
+        return false;
+    }
+    auto dst = static_cast<std::uint8_t*>(data);
+    int nbad = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+ : nbad) if (parallel && nchunk > 1)
+    for (long c = 0; c < nchunk; ++c) {
+        std::uint8_t* out = dst + c * chunk_bytes;
+        std::size_t n = std::min(chunk_bytes, nbytes - c * chunk_bytes);
+        const std::uint8_t* in = p + offsets[c];
+        std::size_t nin = offsets[c + 1] - offsets[c];
+        if (load32(p + header_bytes + c * 4) & stored_as_is) {
+            if (nin != n) {
+                ++nbad;
+                continue;
+            }
+            memcpy(out, in, n);
+            continue;
+        }
+        std::vector<std::uint8_t> transformed(n);
+        if (!lz_decompress(in, nin, transformed.data(), n)) {
+            ++nbad;
+            continue;
+        }
+        inverse(transformed.data(), n, item_size, how, out);
+    }
+    return nbad == 0;
+}
+}  // namespace array_compression
+}  // namespace coreneuron
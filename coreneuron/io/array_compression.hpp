@@ -0,0 +1,67 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace coreneuron {
+
+/*
+Block compression of the binary arrays of data and checkpoint files, see
+FileHandler::compress(). An array is split into chunks of chunk_bytes that are
+compressed independently, and in parallel, with
+    delta encoding of int arrays, which turns sorted index arrays such as
+    nodeindices into small numbers,
+    a byte shuffle that groups the n-th bytes of all items, e.g. the sign and
+    exponent bytes of doubles, and
+    an LZ77 codec with the sequence format of LZ4: a token with the literal and
+    match lengths, the literals, a 2 byte offset and extra length bytes.
+A chunk that does not shrink is stored as is. The encoded array is
+
+    uint8 flags, uint8 item size, uint16 0, uint32 number of chunks,
+    uint32 encoded size of every chunk (high bit set: stored as is),
+    the encoded chunks
+*/
+namespace array_compression {
+
+constexpr std::size_t chunk_bytes = std::size_t(1) << 18;
+
+enum flags : std::uint8_t { shuffle = 1, delta = 2 };
+
+/**
+ * Encode nbytes of items of item_size bytes
+ *
+ * @param delta_encode apply delta encoding, for arrays of int
+ * @param parallel encode the chunks on an OpenMP parallel region
+ */
+std::vector<char> encode(const void* data,
+                         std::size_t nbytes,
+                         std::size_t item_size,
+                         bool delta_encode,
+                         bool parallel);
+
+/**
+ * Decode the result of encode into data of nbytes
+ *
+ * @return false if the encoded array is corrupt or does not have nbytes
+ */
+bool decode(const char* z, std::size_t zbytes, void* data, std::size_t nbytes, bool parallel);
+
+/// LZ compress n bytes into dst of lz_bound(n) bytes, return the compressed size
+std::size_t lz_compress(const std::uint8_t* src, std::size_t n, std::uint8_t* dst);
+/// Decompress into exactly n bytes, false if src is corrupt
+bool lz_decompress(const std::uint8_t* src, std::size_t nsrc, std::uint8_t* dst, std::size_t n);
+
+inline std::size_t lz_bound(std::size_t n) {
+    return n + n / 255 + 16;
+}
+}  // namespace array_compression
+}  // namespace coreneuron
@@ -560,8 +560,7 @@ void core2nrn_tqueue(NrnThread& nt) {
     // (*core2nrn_SelfEvent_event_) from there.
     if (!sewm.empty()) {
         for (int nc_index = 0; nc_index < nt.n_netcon; ++nc_index) {
-            NetCon& nc = nt.netcons[nc_index];
-            int weight_index = nc.u.weight_index_;
+            int weight_index = nrn_netcon_weight_index(&nt, nc_index);
             auto search = sewm.find(weight_index);
             if (search != sewm.end()) {
                 const auto& tqitems = search->second;
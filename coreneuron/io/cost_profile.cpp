@@ -0,0 +1,156 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <cstdio>
+#include <vector>
+
+#include "coreneuron/io/cost_profile.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/coreneuron.hpp"
+#include "coreneuron/io/nrn_checkpoint.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/network/netcon.hpp"
+#include "coreneuron/sim/multicore.hpp"
+
+namespace coreneuron {
+
+bool nrn_cost_profile_enabled = false;
+
+namespace {
+// counters of one NrnThread, only touched by the thread integrating it
+struct ThreadProfile {
+    std::vector<int> cell_of_node;
+    std::vector<int> gid;
+    std::vector<int> ncompartment;
+    std::vector<long> events;
+    std::vector<long> spikes;
+    long events_other = 0;  // delivered to artificial cells
+    double ctime_start = 0.;
+    double deliver_time = 0.;
+};
+std::vector<ThreadProfile> profile_;
+}  // namespace
+
+void nrn_cost_profile_init() {
+    profile_.assign(nrn_nthread, {});
+    for (int it = 0; it < nrn_nthread; ++it) {
+        const NrnThread& nt = nrn_threads[it];
+        auto& p = profile_[it];
+        // the roots are the first ncell nodes and parents precede their children
+        p.cell_of_node.resize(nt.end);
+        for (int i = 0; i < nt.end; ++i) {
+            p.cell_of_node[i] = i < nt.ncell ? i : p.cell_of_node[nt._v_parent_index[i]];
+        }
+        p.gid.assign(nt.ncell, -1);
+        p.ncompartment.assign(nt.ncell, 0);
+        p.events.assign(nt.ncell, 0);
+        p.spikes.assign(nt.ncell, 0);
+        for (int i = 0; i < nt.end; ++i) {
+            ++p.ncompartment[p.cell_of_node[i]];
+        }
+        for (int i = 0; i < nt.n_real_output; ++i) {
+            const PreSyn& ps = nt.presyns[i];
+            if (ps.thvar_index_ >= 0) {
+                p.gid[p.cell_of_node[ps.thvar_index_]] = ps.gid_;
+            }
+        }
+        p.ctime_start = nt._ctime;
+    }
+    nrn_cost_profile_enabled = true;
+}
+
+void nrn_cost_profile_event(NrnThread* nt, const Point_process* target) {
+    auto& p = profile_[nt->id];
+    if (corenrn.get_is_artificial()[target->_type]) {
+        ++p.events_other;
+        return;
+    }
+    const Memb_list* ml = nt->_ml_list[target->_type];
+    ++p.events[p.cell_of_node[ml->nodeindices[target->_i_instance]]];
+}
+
+void nrn_cost_profile_spike(NrnThread* nt, const PreSyn* ps) {
+    auto& p = profile_[nt->id];
+    ++p.spikes[p.cell_of_node[ps->thvar_index_]];
+}
+
+void nrn_cost_profile_deliver_time(NrnThread* nt, double seconds) {
+    profile_[nt->id].deliver_time += seconds;
+}
+
+void nrn_cost_profile_write(const std::string& outpath) {
+    if (!nrn_cost_profile_enabled) {
+        return;
+    }
+    nrn_cost_profile_enabled = false;
+    std::string buf;
+    if (nrnmpi_myid == 0) {
+        buf = "# group gidgroup seconds ncell ncompartment events spikes deliver_seconds\n"
+              "# cell gid gidgroup seconds ncompartment events spikes\n";
+    }
+    for (int it = 0; it < nrn_nthread; ++it) {
+        const NrnThread& nt = nrn_threads[it];
+        const auto& p = profile_[it];
+        if (nt.end == 0 && nt.n_presyn == 0) {
+            continue;  // padding thread without a group
+        }
+        int gidgroup = nrnthread_chkpnt[it].file_id;
+        double seconds = nt._ctime - p.ctime_start;
+        long events = p.events_other;
+        long spikes = 0;
+        for (int c = 0; c < nt.ncell; ++c) {
+            events += p.events[c];
+            spikes += p.spikes[c];
+        }
+        char line[256];
+        int n = snprintf(line,
+                         sizeof(line),
+                         "group %d %.6g %d %d %ld %ld %.6g\n",
+                         gidgroup,
+                         seconds,
+                         nt.ncell,
+                         nt.end,
+                         events,
+                         spikes,
+                         p.deliver_time);
+        buf.append(line, n);
+        for (int c = 0; c < nt.ncell; ++c) {
+            n = snprintf(line,
+                         sizeof(line),
+                         "cell %d %d %.6g %d %ld %ld\n",
+                         p.gid[c],
+                         gidgroup,
+                         nt.end ? seconds * p.ncompartment[c] / nt.end : 0.,
+                         p.ncompartment[c],
+                         p.events[c],
+                         p.spikes[c]);
+            buf.append(line, n);
+        }
+    }
+    profile_.clear();
+
+    std::string fname = outpath + "/cost_profile.dat";
+    if (nrnmpi_myid == 0) {
+        remove(fname.c_str());
+    }
+#if NRNMPI
+    if (corenrn_param.mpi_enable && nrnmpi_initialized()) {
+        nrnmpi_barrier();
+        nrnmpi_write_file(fname, buf.data(), buf.size());
+        return;
+    }
+#endif
+    FILE* f = fopen(fname.c_str(), "w");
+    if (!f) {
+        printf("WARNING: Could not open %s for writing the cost profile\n", fname.c_str());
+        return;
+    }
+    fwrite(buf.data(), 1, buf.size(), f);
+    fclose(f);
+}
+}  // namespace coreneuron
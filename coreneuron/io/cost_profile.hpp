@@ -0,0 +1,41 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <string>
+
+namespace coreneuron {
+struct NrnThread;
+struct Point_process;
+class PreSyn;
+
+/**
+ * \brief Per group and per cell runtime cost profile (--cost-profile)
+ *
+ * While enabled, NetCon::deliver counts the events delivered to every cell
+ * and NetCvode::check_thresh the spikes of every cell. At the end of the run
+ * the profile is written to <outpath>/cost_profile.dat, one line per group and
+ * per cell:
+ *     group <gidgroup> <seconds> <ncell> <ncompartment> <events> <spikes> <deliver seconds>
+ *     cell <gid> <gidgroup> <seconds> <ncompartment> <events> <spikes>
+ * The seconds of a group are its NrnThread::_ctime during the run. The cells
+ * of a group are integrated together, so their seconds are the group seconds
+ * split by compartment count. The file is a valid --cost-file for the next
+ * run, which then distributes the groups by their measured cost.
+ */
+extern bool nrn_cost_profile_enabled;
+
+/// Start profiling, after the model is set up (and permuted)
+void nrn_cost_profile_init();
+void nrn_cost_profile_event(NrnThread* nt, const Point_process* target);
+void nrn_cost_profile_spike(NrnThread* nt, const PreSyn* ps);
+void nrn_cost_profile_deliver_time(NrnThread* nt, double seconds);
+/// Write the profile of all ranks to outpath/cost_profile.dat and stop profiling
+void nrn_cost_profile_write(const std::string& outpath);
+}  // namespace coreneuron
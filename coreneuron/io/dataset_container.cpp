@@ -0,0 +1,234 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <unordered_map>
+
+#include "coreneuron/io/dataset_container.hpp"
+#include "coreneuron/utils/nrn_assert.h"
+
+namespace coreneuron {
+namespace {
+constexpr char magic[8] = {'C', 'N', 'R', 'N', 'D', 'S', 'C', '1'};
+
+struct Header {
+    char magic[8];
+    std::uint64_t nfile;
+    std::uint64_t index_offset;
+};
+
+struct IndexEntry {
+    std::int32_t gid;
+    std::int32_t phase;
+    std::uint64_t offset;
+    std::uint64_t length;
+};
+
+struct Extent {
+    std::uint64_t offset;
+    std::uint64_t length;
+};
+
+struct Container {
+    std::string filename;
+    int fd = -1;
+    bool loaded = false;
+    std::map<std::pair<int, int>, Extent> index;
+};
+
+bool pread_all(int fd, void* buf, std::uint64_t length, std::uint64_t offset) {
+    auto p = static_cast<char*>(buf);
+    while (length > 0) {
+        ssize_t n = pread(fd, p, length, offset);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        length -= n;
+        offset += n;
+    }
+    return true;
+}
+
+class DatasetContainers {
+  public:
+    void open(const std::string& datpath,
+              const std::vector<std::string>& files,
+              const std::vector<int>& gids,
+              const std::vector<int>& container_of) {
+        close();
+        prefix_ = datpath + "/";
+        for (const auto& file: files) {
+            containers_.emplace_back(new Container);
+            containers_.back()->filename = prefix_ + file;
+        }
+        for (std::size_t i = 0; i < gids.size(); ++i) {
+            nrn_assert(container_of[i] >= 0 && container_of[i] < int(files.size()));
+            container_of_[gids[i]] = container_of[i];
+        }
+    }
+
+    void close() {
+        for (auto& c: containers_) {
+            if (c->fd >= 0) {
+                ::close(c->fd);
+            }
+        }
+        containers_.clear();
+        container_of_.clear();
+        prefix_.clear();
+    }
+
+    /// Container and extent of filename, nullptr if it is not in a container
+    Container* find(const std::string& filename, Extent& extent) {
+        if (containers_.empty() || filename.compare(0, prefix_.size(), prefix_) != 0) {
+            return nullptr;
+        }
+        // <gid>_<phase>.dat
+        std::string name = filename.substr(prefix_.size());
+        auto sep = name.find('_');
+        if (sep == std::string::npos || sep == 0 || name.size() < sep + 5 ||
+            name.compare(name.size() - 4, 4, ".dat") != 0) {
+            return nullptr;
+        }
+        char* end;
+        long gid = strtol(name.c_str(), &end, 10);
+        int phase = nrn_dataset_phase_of(name.substr(sep + 1, name.size() - sep - 5));
+        if (end != name.c_str() + sep || phase == 0) {
+            return nullptr;
+        }
+        auto c = container_of_.find(int(gid));
+        if (c == container_of_.end()) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        Container& container = *containers_[c->second];
+        if (!container.loaded) {
+            load(container);
+        }
+        auto it = container.index.find({int(gid), phase});
+        if (it == container.index.end()) {
+            return nullptr;
+        }
+        extent = it->second;
+        return &container;
+    }
+
+  private:
+    void load(Container& c) {
+        c.fd = ::open(c.filename.c_str(), O_RDONLY);
+        if (c.fd < 0) {
+            std::cerr << "cannot open dataset container '" << c.filename << "'" << std::endl;
+            nrn_assert(false);
+        }
+        Header header;
+        nrn_assert(pread_all(c.fd, &header, sizeof(header), 0));
+        if (memcmp(header.magic, magic, sizeof(magic)) != 0) {
+            std::cerr << "'" << c.filename << "' is not a dataset container" << std::endl;
+            nrn_assert(false);
+        }
+        std::vector<IndexEntry> entries(header.nfile);
+        nrn_assert(pread_all(c.fd,
+                             entries.data(),
+                             entries.size() * sizeof(IndexEntry),
+                             header.index_offset));
+        for (const auto& e: entries) {
+            c.index[{e.gid, e.phase}] = Extent{e.offset, e.length};
+        }
+        c.loaded = true;
+    }
+
+    std::string prefix_;
+    std::vector<std::unique_ptr<Container>> containers_;
+    std::unordered_map<int, int> container_of_;
+    // the index is loaded by whichever setup or prefetch thread needs it first
+    std::mutex mutex_;
+};
+
+DatasetContainers datasets_;
+}  // namespace
+
+int nrn_dataset_phase_of(const std::string& suffix) {
+    if (suffix == "1" || suffix == "2" || suffix == "3") {
+        return suffix[0] - '0';
+    }
+    return suffix == "gap" ? 4 : 0;
+}
+
+void nrn_dataset_containers_open(const std::string& datpath,
+                                 const std::vector<std::string>& files,
+                                 const std::vector<int>& gids,
+                                 const std::vector<int>& container_of) {
+    datasets_.open(datpath, files, gids, container_of);
+}
+
+void nrn_dataset_containers_close() {
+    datasets_.close();
+}
+
+bool nrn_dataset_container_has(const std::string& filename) {
+    Extent extent;
+    return datasets_.find(filename, extent) != nullptr;
+}
+
+bool nrn_dataset_container_read(const std::string& filename, std::vector<char>& data) {
+    Extent extent;
+    Container* c = datasets_.find(filename, extent);
+    if (!c) {
+        return false;
+    }
+    data.resize(extent.length);
+    if (!pread_all(c->fd, data.data(), extent.length, extent.offset)) {
+        std::cerr << "cannot read '" << filename << "' from '" << c->filename << "'"
+                  << std::endl;
+        nrn_assert(false);
+    }
+    return true;
+}
+
+DatasetContainerWriter::DatasetContainerWriter(const std::string& filename)
+    : out_(filename, std::ios::out | std::ios::binary | std::ios::trunc) {
+    if (!out_.is_open()) {
+        std::cerr << "cannot open file '" << filename << "'" << std::endl;
+    }
+    nrn_assert(out_.is_open());
+    Header header{};
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    offset_ = sizeof(header);
+}
+
+void DatasetContainerWriter::add(int gid, int phase, const std::vector<char>& data) {
+    nrn_assert(out_.is_open());
+    out_.write(data.data(), data.size());
+    nrn_assert(!out_.fail());
+    index_.push_back(Entry{gid, phase, offset_, data.size()});
+    offset_ += data.size();
+}
+
+void DatasetContainerWriter::close() {
+    if (!out_.is_open()) {
+        return;
+    }
+    static_assert(sizeof(Entry) == sizeof(IndexEntry), "index entry layout");
+    out_.write(reinterpret_cast<const char*>(index_.data()), index_.size() * sizeof(Entry));
+    Header header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.nfile = index_.size();
+    header.index_offset = offset_;
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    nrn_assert(!out_.fail());
+    out_.close();
+}
+}  // namespace coreneuron
@@ -0,0 +1,88 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace coreneuron {
+
+/*
+Dataset containers store the <gid>_<phase>.dat files of many groups in one
+large file, so that loading a model with many groups does not hit the file
+system metadata servers with several open calls per group. A container is
+
+    header:  char magic[8] "CNRNDSC1", uint64 number of files, uint64 index offset
+    data:    the unmodified contents of the files, one after the other
+    index:   per file {int32 gid, int32 phase, uint64 offset, uint64 length}
+
+where phase is 1, 2, 3 or 4 for gap. Integers are in native byte order like
+the data files themselves. The files.dat of a packed dataset gives the container
+of every group next to its gid and lists the container files, relative to the
+dataset directory, at the end:
+
+    1.6
+    2
+    0 0
+    1 1
+    containers 2
+    dataset_0.cnt
+    dataset_1.cnt
+
+Containers are written by coreneuron-pack-dataset from a per group dataset.
+*/
+
+/// Phase number of a data file suffix, "1", "2", "3" or "gap", 0 if none
+int nrn_dataset_phase_of(const std::string& suffix);
+
+/**
+ * Look up the files of the groups of datpath in the given containers
+ *
+ * Called by nrn_read_filesdat, the index of a container is read on first use.
+ * @param container_of container of group gids[i], an index into files
+ */
+void nrn_dataset_containers_open(const std::string& datpath,
+                                 const std::vector<std::string>& files,
+                                 const std::vector<int>& gids,
+                                 const std::vector<int>& container_of);
+void nrn_dataset_containers_close();
+
+/// True if filename is a data file stored in a container
+bool nrn_dataset_container_has(const std::string& filename);
+
+/// Read the contents of filename from its container, false if it is not in one
+bool nrn_dataset_container_read(const std::string& filename, std::vector<char>& data);
+
+/// Writes one container, see coreneuron-pack-dataset
+class DatasetContainerWriter {
+  public:
+    explicit DatasetContainerWriter(const std::string& filename);
+    ~DatasetContainerWriter() {
+        close();
+    }
+
+    void add(int gid, int phase, const std::vector<char>& data);
+    /// Write the index and complete the header
+    void close();
+
+  private:
+    struct Entry {
+        std::int32_t gid;
+        std::int32_t phase;
+        std::uint64_t offset;
+        std::uint64_t length;
+    };
+
+    std::ofstream out_;
+    std::vector<Entry> index_;
+    std::uint64_t offset_{};
+};
+}  // namespace coreneuron
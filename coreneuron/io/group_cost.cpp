@@ -0,0 +1,261 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "coreneuron/io/group_cost.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/coreneuron.hpp"
+#include "coreneuron/io/nrn_filehandler.hpp"
+#include "coreneuron/mechanism/membfunc.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/sim/thread_balance.hpp"
+#include "coreneuron/utils/lpt.hpp"
+#include "coreneuron/utils/utils.hpp"
+
+namespace coreneuron {
+
+bool nrn_cost_calibrate_enabled = false;
+
+namespace {
+// predicted cost of the groups of this rank, in NrnThread order
+std::vector<double> thread_cost_;
+
+// per NrnThread, the current and state seconds of every mechanism type
+std::vector<std::vector<double>> mech_time_;
+std::vector<double> ctime_start_;
+
+double max_over_ranks(double x) {
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        return nrnmpi_dbl_allmax(x);
+    }
+#endif
+    return x;
+}
+}  // namespace
+
+void GroupCostModel::read(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) {
+        nrn_fatal_error("Could not open cost file %s", filename.c_str());
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ls(line.substr(0, line.find('#')));
+        std::string key;
+        if (!(ls >> key) || key == "cell") {
+            continue;
+        }
+        bool ok = false;
+        if (key == "compartment") {
+            ok = static_cast<bool>(ls >> compartment);
+        } else if (key == "mechanism") {
+            std::string name;
+            double c;
+            ok = static_cast<bool>(ls >> name >> c);
+            mechanism[name] = c;
+        } else if (key == "group") {
+            int gidgroup;
+            double c;
+            ok = static_cast<bool>(ls >> gidgroup >> c);
+            group[gidgroup] = c;
+        }
+        if (!ok) {
+            nrn_fatal_error("Invalid line in cost file %s: %s", filename.c_str(), line.c_str());
+        }
+    }
+}
+
+double GroupCostModel::cost(const std::string& datpath, int gidgroup) const {
+    auto measured = group.find(gidgroup);
+    if (measured != group.end()) {
+        return measured->second;
+    }
+    // the counts are at the start of the phase2 header, see Phase2::read_file
+    FileHandler F(datpath + "/" + std::to_string(gidgroup) + "_2.dat");
+    F.read_int();  // n_real_cell
+    F.read_int();  // n_output
+    F.read_int();  // n_real_output
+    int n_node = F.read_int();
+    F.read_int();  // n_diam
+    int n_mech = F.read_int();
+    double c = compartment * n_node;
+    for (int i = 0; i < n_mech; ++i) {
+        int type = F.read_int();
+        int count = F.read_int();
+        const char* name = nrn_get_mechname(type);
+        auto it = name ? mechanism.find(name) : mechanism.end();
+        c += (it == mechanism.end() ? 1. : it->second) * count;
+    }
+    F.close();
+    return c;
+}
+
+std::vector<int> nrn_group_distribute(const std::vector<int>& groups, const char* datpath) {
+    int n = groups.size();
+    int nrank = nrnmpi_numprocs;
+    std::vector<int> mine;
+    thread_cost_.clear();
+    if (!corenrn_param.cost_balance || n == 0) {
+        for (int i = nrnmpi_myid; i < n; i += nrank) {
+            mine.push_back(groups[i]);
+        }
+        return mine;
+    }
+
+    GroupCostModel model;
+    if (!corenrn_param.cost_file.empty()) {
+        model.read(corenrn_param.cost_file);
+    }
+    // every rank reads the headers of its round robin share
+    std::vector<double> cost(n, 0.);
+    for (int i = nrnmpi_myid; i < n; i += nrank) {
+        cost[i] = model.cost(datpath, groups[i]);
+    }
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        std::vector<double> all(n);
+        nrnmpi_dbl_allreduce_vec(cost.data(), all.data(), n, 1);
+        cost.swap(all);
+    }
+#endif
+
+    // lpt works on integer sizes
+    double cmax = *std::max_element(cost.begin(), cost.end());
+    std::vector<std::size_t> pieces(n, 0);
+    for (int i = 0; i < n && cmax > 0.; ++i) {
+        pieces[i] = static_cast<std::size_t>(cost[i] / cmax * 1e9);
+    }
+    double bal;
+    auto bag = lpt(nrank, pieces, &bal);
+    std::vector<int> rank_of(bag.begin(), bag.end());
+    std::vector<int> round_robin(n);
+    for (int i = 0; i < n; ++i) {
+        round_robin[i] = i % nrank;
+    }
+    if (nrank > 1 && nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Cost balance: predicted rank imbalance %.1f%% (round robin %.1f%%)\n",
+               100. * nrn_thread_imbalance(cost, rank_of, nrank),
+               100. * nrn_thread_imbalance(cost, round_robin, nrank));
+    }
+
+    // the groups of this rank, most expensive first
+    std::vector<int> index;
+    for (int i = 0; i < n; ++i) {
+        if (rank_of[i] == nrnmpi_myid) {
+            index.push_back(i);
+        }
+    }
+    std::stable_sort(index.begin(), index.end(), [&cost](int a, int b) {
+        return cost[a] > cost[b];
+    });
+    for (int i: index) {
+        mine.push_back(groups[i]);
+        thread_cost_.push_back(cost[i]);
+    }
+    return mine;
+}
+
+void nrn_group_thread_assign() {
+    if (!corenrn_param.cost_balance) {
+        return;
+    }
+    int nmember = nrn_thread_team_size();
+    double before = 0., after = 0.;
+    if (nmember > 1) {
+        std::vector<double> cost(nrn_nthread, 0.);
+        std::copy(thread_cost_.begin(), thread_cost_.end(), cost.begin());
+        std::vector<int> round_robin(nrn_nthread);
+        for (int i = 0; i < nrn_nthread; ++i) {
+            round_robin[i] = i % nmember;
+        }
+        auto member_of = nrn_thread_lpt_assign(cost, nmember);
+        nrn_thread_team_assign(member_of);
+        before = nrn_thread_imbalance(cost, round_robin, nmember);
+        after = nrn_thread_imbalance(cost, member_of, nmember);
+    }
+    before = max_over_ranks(before);
+    after = max_over_ranks(after);
+    if (nmember > 1 && nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Cost balance: predicted thread imbalance %.1f%% (round robin %.1f%%)\n",
+               100. * after,
+               100. * before);
+    }
+}
+
+void nrn_cost_calibrate_init() {
+    mech_time_.assign(nrn_nthread, std::vector<double>(corenrn.get_memb_funcs().size(), 0.));
+    ctime_start_.resize(nrn_nthread);
+    for (int it = 0; it < nrn_nthread; ++it) {
+        ctime_start_[it] = nrn_threads[it]._ctime;
+    }
+    nrn_cost_calibrate_enabled = true;
+}
+
+void nrn_cost_calibrate_mech_time(NrnThread* nt, int type, double seconds) {
+    mech_time_[nt->id][type] += seconds;
+}
+
+void nrn_cost_calibrate_write(const std::string& outpath) {
+    if (!nrn_cost_calibrate_enabled) {
+        return;
+    }
+    nrn_cost_calibrate_enabled = false;
+    int ntype = corenrn.get_memb_funcs().size();
+    // per type the seconds and the instances, then the compartment seconds and count
+    std::vector<double> sum(2 * ntype + 2, 0.);
+    for (int it = 0; it < nrn_nthread; ++it) {
+        const NrnThread& nt = nrn_threads[it];
+        double other = nt._ctime - ctime_start_[it];
+        for (auto tml = nt.tml; tml; tml = tml->next) {
+            sum[2 * tml->index] += mech_time_[it][tml->index];
+            sum[2 * tml->index + 1] += tml->ml->nodecount;
+            other -= mech_time_[it][tml->index];
+        }
+        sum[2 * ntype] += std::max(other, 0.);
+        sum[2 * ntype + 1] += nt.end;
+    }
+    mech_time_.clear();
+    ctime_start_.clear();
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        std::vector<double> all(sum.size());
+        nrnmpi_dbl_allreduce_vec(sum.data(), all.data(), sum.size(), 1);
+        sum.swap(all);
+    }
+#endif
+    if (nrnmpi_myid != 0) {
+        return;
+    }
+
+    std::string fname = outpath + "/cost_model.dat";
+    FILE* f = fopen(fname.c_str(), "w");
+    if (!f) {
+        printf("WARNING: Could not open %s for writing the cost model\n", fname.c_str());
+        return;
+    }
+    fprintf(f, "# compartment seconds\n# mechanism name seconds\n");
+    if (sum[2 * ntype + 1] > 0.) {
+        fprintf(f, "compartment %.6g\n", sum[2 * ntype] / sum[2 * ntype + 1]);
+    }
+    for (int type = 0; type < ntype; ++type) {
+        if (sum[2 * type + 1] > 0.) {
+            fprintf(f,
+                    "mechanism %s %.6g\n",
+                    nrn_get_mechname(type),
+                    sum[2 * type] / sum[2 * type + 1]);
+        }
+    }
+    fclose(f);
+}
+}  // namespace coreneuron
@@ -0,0 +1,72 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace coreneuron {
+struct NrnThread;
+
+/**
+ * \brief Predicted compute cost of the cell groups of a dataset
+ *
+ * The cost of a group is the number of compartments times the compartment
+ * (matrix solve) cost plus, for every mechanism, the number of instances times
+ * the cost of an instance, all taken from the header of <group>_2.dat. A cost
+ * file can give these costs, as calibrated by a --cost-calibrate run, or the
+ * measured cost of whole groups, one entry per line and # for comments:
+ *     compartment <cost>
+ *     mechanism <name> <cost>
+ *     group <gidgroup> <cost>
+ * Costs are relative, the default of every entry is 1. Further columns and
+ * cell lines are ignored, so a --cost-profile output is a valid cost file.
+ */
+struct GroupCostModel {
+    double compartment = 1.;
+    std::map<std::string, double> mechanism;
+    std::map<int, double> group;
+
+    void read(const std::string& filename);
+    /// cost of gidgroup in the dataset at datpath
+    double cost(const std::string& datpath, int gidgroup) const;
+};
+
+/**
+ * Distribute the groups of files.dat over the ranks
+ *
+ * Without --cost-balance the groups are distributed round robin in files.dat
+ * order. Otherwise they are distributed with LPT by their predicted cost and
+ * the groups of a rank are ordered by decreasing cost.
+ *
+ * @return the groups of this rank in NrnThread order
+ */
+std::vector<int> nrn_group_distribute(const std::vector<int>& groups, const char* datpath);
+
+/// With --cost-balance, assign the NrnThreads to the thread team members with LPT
+/// by their predicted cost and report the predicted thread imbalance
+void nrn_group_thread_assign();
+
+/**
+ * Calibration of the cost model (--cost-calibrate)
+ *
+ * While enabled, the current and state functions of every mechanism are timed.
+ * At the end of the run the weights fitted over all ranks, seconds per instance
+ * of every mechanism and seconds per compartment for the remaining step time,
+ * are written to <outpath>/cost_model.dat as a cost file for --cost-file.
+ */
+extern bool nrn_cost_calibrate_enabled;
+
+/// Start timing, after the model is set up
+void nrn_cost_calibrate_init();
+void nrn_cost_calibrate_mech_time(NrnThread* nt, int type, double seconds);
+/// Write the fitted weights to outpath/cost_model.dat and stop timing
+void nrn_cost_calibrate_write(const std::string& outpath);
+}  // namespace coreneuron
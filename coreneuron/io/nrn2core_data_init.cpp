@@ -206,7 +206,7 @@ static void nrn2core_tqueue() {
                         int netcon_index = ncte->intdata[idat++];  // via the NetCon
                         int weight_index = -1;                     // no associated netcon
                         if (netcon_index >= 0) {
-                            weight_index = nt.netcons[netcon_index].u.weight_index_;
+                            weight_index = nrn_netcon_weight_index(&nt, netcon_index);
                         }
 
                         double flag = ncte->dbldata[idbldat++];
@@ -5,10 +5,15 @@
 # See top-level LICENSE file for details.
 # =============================================================================.
 */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <cassert>
 #include <memory>
+#include <type_traits>
 
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/nrniv/nrniv_decl.h"
@@ -24,22 +29,101 @@
 #include "coreneuron/permute/node_permute.h"
 #include "coreneuron/coreneuron.hpp"
 #include "coreneuron/utils/nrnoc_aux.hpp"
+#include "coreneuron/utils/utils.hpp"
 #include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/gpu/nrn_acc_manager.hpp"
+#include "coreneuron/mechanism/index_compression.hpp"
 
 namespace coreneuron {
 // Those functions comes from mod file directly
 extern int checkpoint_save_patternstim(_threadargsproto_);
 extern void checkpoint_restore_patternstim(int, double, _threadargsproto_);
 
-CheckPoints::CheckPoints(const std::string& save, const std::string& restore)
+// Records the text and arrays that write_bbcore and write_tqueue produce, to
+// write them to a file later on
+class StagedOutput {
+  public:
+    template <typename T>
+    StagedOutput& operator<<(const T& x) {
+        text_ << x;
+        return *this;
+    }
+
+    template <typename T>
+    void write_array(const T* p, std::size_t n) {
+        static_assert(std::is_same<T, int>::value || std::is_same<T, double>::value,
+                      "only int and double arrays are staged");
+        Item item;
+        item.text = text_.str();
+        text_.str("");
+        item.is_double = std::is_same<T, double>::value;
+        if constexpr (std::is_same<T, double>::value) {
+            item.doubles.assign(p, p + n);
+        } else {
+            item.ints.assign(p, p + n);
+        }
+        items_.push_back(std::move(item));
+    }
+
+    void write_to(FileHandler& fh) const {
+        for (const auto& item: items_) {
+            fh << item.text;
+            if (item.is_double) {
+                fh.write_array(item.doubles.data(), item.doubles.size());
+            } else {
+                fh.write_array(item.ints.data(), item.ints.size());
+            }
+        }
+        fh << text_.str();
+    }
+
+  private:
+    struct Item {
+        std::string text;  // written before the array
+        bool is_double;
+        std::vector<int> ints;
+        std::vector<double> doubles;
+    };
+    std::vector<Item> items_;
+    std::ostringstream text_;
+};
+
+// Copy of a thread for a native checkpoint
+struct CheckPoints::NativeThread {
+    int file_id;
+    std::vector<std::size_t> layout;
+    StagedOutput state;  // everything after the layout, see stage_native
+};
+
+CheckPoints::CheckPoints(const std::string& save, const std::string& restore, double interval)
     : save_(save)
     , restore_(restore)
-    , restored(false) {
+    , restore_native_(!restore.empty() && FileHandler::file_exist(restore + "/native.dat"))
+    , interval_(interval)
+    , native_nrank(0)
+    , native_nthread(0)
+    , restored(false)
+    , ninterval(0)
+    , interval_time(0.) {
     if (!save.empty()) {
         if (nrnmpi_myid == 0) {
             mkdir_p(save.c_str());
         }
     }
+    if (restore_native_) {
+        FileHandler f(restore + "/native.dat");
+        native_nrank = f.read_int();
+        native_nthread = f.read_int();
+        f.close();
+    }
+}
+
+// Without a last join point on all ranks, the pending interval checkpoint is
+// left without its native.dat and is not restorable.
+CheckPoints::~CheckPoints() {
+    if (interval_writer.joinable()) {
+        interval_writer.join();
+    }
 }
 
 /// todo : need to broadcast this rather than all reading a double
@@ -57,16 +141,18 @@ double CheckPoints::restore_time() const {
     return rtime;
 }
 
-void CheckPoints::write_checkpoint(NrnThread* nt, int nb_threads) const {
+void CheckPoints::write_checkpoint(NrnThread* nt, int nb_threads) {
     if (!should_save()) {
         return;
     }
+    finish_interval_checkpoint();
 
 #if NRNMPI
     if (corenrn_param.mpi_enable) {
         nrnmpi_barrier();
     }
 #endif
+    double wt = nrn_wtime();
 
     /**
      * if openmp threading needed:
@@ -74,18 +160,95 @@ void CheckPoints::write_checkpoint(NrnThread* nt, int nb_threads) const {
      */
     for (int i = 0; i < nb_threads; i++) {
         if (nt[i].ncell || nt[i].tml) {
-            write_phase2(nt[i]);
+            if (corenrn_param.checkpoint_native) {
+                NativeThread s;
+                stage_native(nt[i], s);
+                write_native(s, save_);
+            } else {
+                write_phase2(nt[i]);
+            }
         }
     }
 
     if (nrnmpi_myid == 0) {
-        write_time();
+        write_time(save_, t);
+        write_native_info(save_, corenrn_param.checkpoint_native);
+    }
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        nrnmpi_barrier();
+    }
+#endif
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Checkpoint written in %.2lf seconds (%s)\n",
+               nrn_wtime() - wt,
+               corenrn_param.checkpoint_native ? "native" : "phase 2");
+    }
+}
+
+double CheckPoints::next_interval_time(double time, double mindelay) const {
+    if (!should_save() || interval_ <= 0.) {
+        return std::numeric_limits<double>::max();
+    }
+    // a multiple of the min delay, where the spikes are exchanged anyway
+    double step = std::max(1., std::ceil(interval_ / mindelay - 1e-9)) * mindelay;
+    return (std::floor(time / step + 1e-9) + 1.) * step;
+}
+
+// The state is copied on the calling thread, which only takes as long as a
+// memcpy of the arrays, and written on interval_writer while the simulation
+// continues. The checkpoint goes into interval_<n> of the checkpoint directory
+// and can be restored like a --checkpoint-native one once it is completed by
+// finish_interval_checkpoint. At most one checkpoint is written at a time.
+void CheckPoints::write_interval_checkpoint(NrnThread* nt, int nb_threads) {
+    finish_interval_checkpoint();
+    update_nrnthreads_on_host(nt, nb_threads);
+    update_weights_from_gpu(nt, nb_threads);
+
+    std::vector<NativeThread> staged;
+    for (int i = 0; i < nb_threads; i++) {
+        if (nt[i].ncell || nt[i].tml) {
+            staged.emplace_back();
+            stage_native(nt[i], staged.back());
+        }
+    }
+    interval_dir = save_ + "/interval_" + std::to_string(++ninterval);
+    interval_time = t;
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Interval checkpoint at t=%g into %s\n", interval_time, interval_dir.c_str());
+    }
+    // every rank creates it, an existing directory is not an error
+    if (mkdir_p(interval_dir.c_str()) != 0) {
+        hoc_execerror("Cannot create the interval checkpoint directory", interval_dir.c_str());
+    }
+    interval_writer = std::thread([this, staged = std::move(staged), dir = interval_dir]() {
+        for (const auto& s: staged) {
+            // leave the cores to the simulation
+            write_native(s, dir, false);
+        }
+    });
+}
+
+// Waits for the files of this rank, then for the ones of all ranks, and only
+// then marks the interval checkpoint as restorable by writing native.dat.
+// Must be called by all ranks at the same point of the simulation.
+void CheckPoints::finish_interval_checkpoint() {
+    if (interval_writer.joinable()) {
+        interval_writer.join();
+    }
+    if (interval_dir.empty()) {
+        return;
     }
 #if NRNMPI
     if (corenrn_param.mpi_enable) {
         nrnmpi_barrier();
     }
 #endif
+    if (nrnmpi_myid == 0) {
+        write_time(interval_dir, interval_time);
+        write_native_info(interval_dir, true);
+    }
+    interval_dir.clear();
 }
 
 // Factor out the body of ion handling below as the same code
@@ -122,6 +285,7 @@ void CheckPoints::write_phase2(NrnThread& nt) const {
     auto filename = get_save_path() + "/" + std::to_string(ntc.file_id) + "_2.dat";
 
     fh.open(filename, std::ios::out);
+    fh.compress(corenrn_param.checkpoint_compress);
     fh.checkpoint(2);
 
     int n_outputgid = 0;  // calculate PreSyn with gid >= 0
@@ -241,7 +405,7 @@ void CheckPoints::write_phase2(NrnThread& nt) const {
             int* nd_ix = new int[cnt];
             for (int i = 0; i < cnt; ++i) {
                 int ip = ml->_permute ? ml->_permute[i] : i;
-                int ipval = ml->nodeindices[ip];
+                int ipval = nrn_nodeindex(ml, ip);
                 nd_ix[i] = pinv_nt[ipval];
             }
             fh.write_array<int>(nd_ix, cnt);
@@ -253,7 +417,9 @@ void CheckPoints::write_phase2(NrnThread& nt) const {
         sz = nrn_prop_dparam_size_[type];
         if (sz) {
             // need to update some values according to Datum semantics.
-            int* d = soa2aos(ml->pdata, cnt, sz, layout, ml->_permute);
+            std::vector<int> pdata16;
+            int* pdata = nrn_pdata_int(ml, std::size_t(ml->_nodecount_padded) * sz, pdata16);
+            int* d = soa2aos(pdata, cnt, sz, layout, ml->_permute);
             std::vector<int> pointer2type;  // voltage or mechanism type (starts empty)
             if (!nrn_is_artificial_[type]) {
                 for (int i_instance = 0; i_instance < cnt; ++i_instance) {
@@ -375,8 +541,7 @@ void CheckPoints::write_phase2(NrnThread& nt) const {
     int* pntindex = new int[nnetcon];
     double* delay = new double[nnetcon];
     for (int i = 0; i < nnetcon; ++i) {
-        NetCon& nc = nt.netcons[i];
-        Point_process* pnt = nc.target_;
+        Point_process* pnt = nt.netcons[i].target();
         if (pnt == nullptr) {
             // nrn_setup.cpp allows type <=0 which generates nullptr target.
             pnttype[i] = 0;
@@ -395,7 +560,7 @@ void CheckPoints::write_phase2(NrnThread& nt) const {
             int ix = (pnt - nt.pntprocs) - pnt_offset[pnt->_type];
             pntindex[i] = ix;
         }
-        delay[i] = nc.delay_;
+        delay[i] = nt.netcon_delay[i];
     }
     fh.write_array<int>(pnttype, nnetcon);
     fh.write_array<int>(pntindex, nnetcon);
@@ -412,6 +577,76 @@ void CheckPoints::write_phase2(NrnThread& nt) const {
     delete[] pntindex;
     delete[] delay;
 
+    write_bbcore(nt, fh);
+
+    fh << nt.n_vecplay << " VecPlay instances\n";
+    for (int i = 0; i < nt.n_vecplay; i++) {
+        PlayRecord* pr = (PlayRecord*) nt._vecplay[i];
+        int vtype = pr->type();
+        int mtype = -1;
+        int ix = -1;
+
+        // not as efficient as possible but there should not be too many
+        Memb_list* ml = nullptr;
+        for (NrnThreadMembList* tml = nt.tml; tml; tml = tml->next) {
+            ml = tml->ml;
+            int nn = corenrn.get_prop_param_size()[tml->index] * ml->nodecount;
+            if (nn && pr->pd_ >= ml->data && pr->pd_ < (ml->data + nn)) {
+                mtype = tml->index;
+                ix = (pr->pd_ - ml->data);
+                break;
+            }
+        }
+        assert(mtype >= 0);
+        int icnt, isz;
+        nrn_inverse_i_layout(ix,
+                             icnt,
+                             ml->nodecount,
+                             isz,
+                             corenrn.get_prop_param_size()[mtype],
+                             corenrn.get_mech_data_layout()[mtype]);
+        if (ml_pinv[mtype]) {
+            icnt = ml_pinv[mtype][icnt];
+        }
+        ix = nrn_i_layout(
+            icnt, ml->nodecount, isz, corenrn.get_prop_param_size()[mtype], AOS_LAYOUT);
+
+        fh << vtype << "\n";
+        fh << mtype << "\n";
+        fh << ix << "\n";
+#if CHKPNTDEBUG
+        assert(ntc.vtype[i] == vtype);
+        assert(ntc.mtype[i] == mtype);
+        assert(ntc.vecplay_ix[i] == ix);
+#endif
+        if (vtype == VecPlayContinuousType) {
+            VecPlayContinuous* vpc = (VecPlayContinuous*) pr;
+            int sz = vpc->y_.size();
+            fh << sz << "\n";
+            fh.write_array<double>(vpc->y_.data(), sz);
+            fh.write_array<double>(vpc->t_.data(), sz);
+        } else {
+            std::cerr << "Error checkpointing vecplay type" << std::endl;
+            assert(0);
+        }
+    }
+
+    for (size_t i = 0; i < memb_func.size(); ++i) {
+        if (ml_pinv[i]) {
+            delete[] ml_pinv[i];
+        }
+    }
+    free(ml_pinv);
+
+    write_tqueue(nt, fh);
+    fh.close();
+}
+
+template <typename Output>
+void CheckPoints::write_bbcore(NrnThread& nt, Output& fh) const {
+#if CHKPNTDEBUG
+    NrnThreadChkpnt& ntc = nrnthread_chkpnt[nt.id];
+#endif
     // BBCOREPOINTER
     int nbcp = 0;
     for (NrnThreadMembList* tml = nt.tml; tml; tml = tml->next) {
@@ -482,86 +717,209 @@ void CheckPoints::write_phase2(NrnThread& nt) const {
             }
 
             if (icnt) {
-                fh.write_array<int>(iArray, icnt);
+                fh.write_array(iArray, icnt);
                 delete[] iArray;
             }
 
             if (dcnt) {
-                fh.write_array<double>(dArray, dcnt);
+                fh.write_array(dArray, dcnt);
                 delete[] dArray;
             }
             ++i;
         }
     }
+}
 
-    fh << nt.n_vecplay << " VecPlay instances\n";
-    for (int i = 0; i < nt.n_vecplay; i++) {
-        PlayRecord* pr = (PlayRecord*) nt._vecplay[i];
-        int vtype = pr->type();
-        int mtype = -1;
-        int ix = -1;
+// Everything the raw arrays of a native checkpoint depend on. Restoring
+// requires that the same dataset is set up in the same way.
+std::vector<std::size_t> CheckPoints::native_layout(const NrnThread& nt) const {
+    std::vector<std::size_t> layout{static_cast<std::size_t>(nrnmpi_numprocs),
+                                    static_cast<std::size_t>(nrn_nthread),
+                                    static_cast<std::size_t>(nt.id),
+                                    static_cast<std::size_t>(nrnthread_chkpnt[nt.id].file_id),
+                                    corenrn_param.cell_interleave_permute,
+                                    corenrn_param.nwarp,
+                                    static_cast<std::size_t>(nt.ncell),
+                                    static_cast<std::size_t>(nt.end),
+                                    nt._ndata,
+                                    static_cast<std::size_t>(nt.n_weight),
+                                    static_cast<std::size_t>(nt.n_presyn),
+                                    static_cast<std::size_t>(nt.n_netcon)};
+    for (NrnThreadMembList* tml = nt.tml; tml; tml = tml->next) {
+        layout.push_back(tml->index);
+        layout.push_back(tml->ml->nodecount);
+        layout.push_back(tml->ml->_nodecount_padded);
+        layout.push_back(corenrn.get_mech_data_layout()[tml->index]);
+        layout.push_back(tml->ml->data - nt._data);
+    }
+    return layout;
+}
 
-        // not as efficient as possible but there should not be too many
-        Memb_list* ml = nullptr;
-        for (NrnThreadMembList* tml = nt.tml; tml; tml = tml->next) {
-            ml = tml->ml;
-            int nn = corenrn.get_prop_param_size()[tml->index] * ml->nodecount;
-            if (nn && pr->pd_ >= ml->data && pr->pd_ < (ml->data + nn)) {
-                mtype = tml->index;
-                ix = (pr->pd_ - ml->data);
-                break;
-            }
+// The native checkpoint holds the arrays of the thread as they are in memory,
+// i.e. permuted, in SoA layout and with the pdata relocated, so that restoring
+// reads it instead of the phase 2 file of the dataset and only copies the arrays:
+//   layout descriptor, see native_layout()
+//   chkpnt number that the phase 3 file of the dataset continues from
+//   sizes and mechanism types as in the phase 2 file
+//   _v_parent_index and, if the nodes are permuted, _permute
+//   _data
+//   for every mechanism nodeindices, _permute if any and the padded pdata
+//   PreSyn voltage indices (already permuted) and thresholds
+//   NetCon targets, weight indices and delays, and the weights
+//   VecPlayContinuous with the index into the data of their mechanism
+//   BBCOREPOINTER data and event queue as in the phase2 checkpoint, see write_tqueue
+void CheckPoints::stage_native(NrnThread& nt, NativeThread& s) const {
+    s.file_id = nrnthread_chkpnt[nt.id].file_id;
+    s.layout = native_layout(nt);
+    auto& out = s.state;
+    out << nrnthread_chkpnt[nt.id].phase3_chkpnt << " phase3 chkpnt\n";
+    out << nt.ncell << " ncell\n";
+    out << nt.n_real_output << " n_real_output\n";
+    out << nt.end << " nnode\n";
+    out << ((nt._actual_diam == nullptr) ? 0 : nt.end) << " ndiam\n";
+    int nmech = 0;
+    for (NrnThreadMembList* tml = nt.tml; tml; tml = tml->next) {
+        ++nmech;
+    }
+    out << nmech << " nmech\n";
+    for (NrnThreadMembList* tml = nt.tml; tml; tml = tml->next) {
+        out << tml->index << "\n";
+        out << tml->ml->nodecount << "\n";
+    }
+    out << nt._nidata << " nidata\n";
+    out << nt._nvdata << " nvdata\n";
+    out << nt.n_weight << " nweight\n";
+
+    out.write_array(nt._v_parent_index, nt.end);
+    out << (nt._permute ? 1 : 0) << " permute\n";
+    if (nt._permute) {
+        out.write_array(nt._permute, nt.end);
+    }
+    out.write_array(nt._data, nt._ndata);
+    for (NrnThreadMembList* tml = nt.tml; tml; tml = tml->next) {
+        Memb_list* ml = tml->ml;
+        int cnt = ml->nodecount;
+        std::vector<int> nodeindices(cnt);
+        for (int i = 0; i < cnt; ++i) {
+            nodeindices[i] = nrn_nodeindex(ml, i);
         }
-        assert(mtype >= 0);
-        int icnt, isz;
-        nrn_inverse_i_layout(ix,
-                             icnt,
-                             ml->nodecount,
-                             isz,
-                             corenrn.get_prop_param_size()[mtype],
-                             corenrn.get_mech_data_layout()[mtype]);
-        if (ml_pinv[mtype]) {
-            icnt = ml_pinv[mtype][icnt];
+        out.write_array(nodeindices.data(), cnt);
+        out << (ml->_permute ? 1 : 0) << " permute\n";
+        if (ml->_permute) {
+            out.write_array(ml->_permute, cnt);
         }
-        ix = nrn_i_layout(
-            icnt, ml->nodecount, isz, corenrn.get_prop_param_size()[mtype], AOS_LAYOUT);
+        int szdp = corenrn.get_prop_dparam_size()[tml->index];
+        if (szdp) {
+            std::size_t n = static_cast<std::size_t>(ml->_nodecount_padded) * szdp;
+            std::vector<int> pdata16;
+            out.write_array(nrn_pdata_int(ml, n, pdata16), n);
+        }
+    }
 
-        fh << vtype << "\n";
-        fh << mtype << "\n";
-        fh << ix << "\n";
-#if CHKPNTDEBUG
-        assert(ntc.vtype[i] == vtype);
-        assert(ntc.mtype[i] == mtype);
-        assert(ntc.vecplay_ix[i] == ix);
-#endif
-        if (vtype == VecPlayContinuousType) {
-            VecPlayContinuous* vpc = (VecPlayContinuous*) pr;
-            int sz = vpc->y_.size();
-            fh << sz << "\n";
-            fh.write_array<double>(vpc->y_.data(), sz);
-            fh.write_array<double>(vpc->t_.data(), sz);
+    // as Phase2::populate has them after the permutation
+    std::vector<int> output_vindex(nt.n_presyn);
+    std::vector<double> output_threshold(nt.n_real_output);
+    for (int i = 0; i < nt.n_presyn; ++i) {
+        PreSyn* ps = nt.presyns + i;
+        if (ps->thvar_index_ >= 0) {
+            output_vindex[i] = ps->thvar_index_;
+            output_threshold[i] = ps->threshold_;
+        } else if (i < nt.n_real_output) {  // real cell without a presyn
+            output_vindex[i] = -1;
         } else {
-            std::cerr << "Error checkpointing vecplay type" << std::endl;
-            assert(0);
+            Point_process* pnt = ps->pntsrc_;
+            int index = (pnt - nt.pntprocs) - nt._pnt_offset[pnt->_type];
+            output_vindex[i] = -(index * 1000 + pnt->_type);
         }
     }
+    out.write_array(output_vindex.data(), output_vindex.size());
+    out.write_array(output_threshold.data(), output_threshold.size());
+
+    std::vector<int> netcon_target(nt.n_netcon);
+    std::vector<int> netcon_weight_index(nt.n_netcon);
+    for (int i = 0; i < nt.n_netcon; ++i) {
+        netcon_target[i] = nrn_netcon_target(&nt, i);
+        netcon_weight_index[i] = nrn_netcon_weight_index(&nt, i);
+    }
+    out.write_array(netcon_target.data(), netcon_target.size());
+    out.write_array(netcon_weight_index.data(), netcon_weight_index.size());
+    out.write_array(nt.netcon_delay, nt.n_netcon);
+    out.write_array(nt.weights, nt.n_weight);
 
-    for (size_t i = 0; i < memb_func.size(); ++i) {
-        if (ml_pinv[i]) {
-            delete[] ml_pinv[i];
+    out << nt.n_vecplay << " VecPlay instances\n";
+    for (int i = 0; i < nt.n_vecplay; i++) {
+        auto* vpc = static_cast<VecPlayContinuous*>(nt._vecplay[i]);
+        assert(vpc->type() == VecPlayContinuousType);
+        NrnThreadMembList* tml = nt.tml;
+        for (; tml; tml = tml->next) {
+            Memb_list* ml = tml->ml;
+            std::size_t nn = corenrn.get_prop_param_size()[tml->index] *
+                             static_cast<std::size_t>(ml->_nodecount_padded);
+            if (nn && vpc->pd_ >= ml->data && vpc->pd_ < ml->data + nn) {
+                break;
+            }
         }
+        assert(tml);
+        out << vpc->type() << "\n";
+        out << tml->index << "\n";
+        out << (vpc->pd_ - tml->ml->data) << "\n";
+        int sz = vpc->y_.size();
+        out << sz << "\n";
+        out.write_array(vpc->y_.data(), sz);
+        out.write_array(vpc->t_.data(), sz);
     }
-    free(ml_pinv);
 
-    write_tqueue(nt, fh);
+    write_bbcore(nt, out);
+    write_tqueue(nt, out);
+}
+
+void CheckPoints::write_native(const NativeThread& s,
+                               const std::string& dir,
+                               bool parallel_compress) const {
+    FileHandler fh;
+    auto filename = dir + "/" + std::to_string(s.file_id) + "_native.dat";
+    fh.open(filename, std::ios::out);
+    fh.compress(corenrn_param.checkpoint_compress, parallel_compress);
+    fh.checkpoint(2);
+
+    fh << s.layout.size() << " layout\n";
+    fh.write_array(s.layout.data(), s.layout.size());
+    s.state.write_to(fh);
     fh.close();
 }
 
-void CheckPoints::write_time() const {
+// Marks a native checkpoint and records the configuration it was written with.
+// A phase2 checkpoint into the same directory removes a stale marker.
+void CheckPoints::write_native_info(const std::string& dir, bool native) const {
+    auto filename = dir + "/native.dat";
+    if (!native) {
+        std::remove(filename.c_str());
+        return;
+    }
+    FileHandler f;
+    f.open(filename, std::ios::out);
+    f << nrnmpi_numprocs << " nrank\n";
+    f << nrn_nthread << " nthread\n";
+    f.close();
+}
+
+void CheckPoints::check_native(const NrnThread& nt, const std::vector<std::size_t>& layout) const {
+    if (native_nrank != nrnmpi_numprocs || native_nthread != nrn_nthread) {
+        hoc_execerror("native checkpoint needs the number of ranks and threads",
+                      "it was written with");
+    }
+    if (layout != native_layout(nt)) {
+        hoc_execerror(std::to_string(nrnthread_chkpnt[nt.id].file_id).c_str(),
+                      "native checkpoint does not match the dataset, ranks, threads and "
+                      "permutation options");
+    }
+}
+
+void CheckPoints::write_time(const std::string& dir, double time) const {
     FileHandler f;
-    auto filename = get_save_path() + "/time.dat";
+    auto filename = dir + "/time.dat";
     f.open(filename, std::ios::out);
-    f.write_array(&t, 1);
+    f.write_array(&time, 1);
     f.close();
 }
 
@@ -652,7 +1010,8 @@ NrnThreadChkpnt* nrnthread_chkpnt;
 
 int patstimtype;
 
-void CheckPoints::write_tqueue(TQItem* q, NrnThread& nt, FileHandler& fh) const {
+template <typename Output>
+void CheckPoints::write_tqueue(TQItem* q, NrnThread& nt, Output& fh) const {
     DiscreteEvent* d = (DiscreteEvent*) q->data_;
 
     // printf("  p %.20g %d\n", q->t_, d->type());
@@ -780,7 +1139,8 @@ void CheckPoints::restore_tqitem(int type,
     }
 }
 
-void CheckPoints::write_tqueue(NrnThread& nt, FileHandler& fh) const {
+template <typename Output>
+void CheckPoints::write_tqueue(NrnThread& nt, Output& fh) const {
     // VecPlayContinuous
     fh << nt.n_vecplay << " VecPlayContinuous state\n";
     for (int i = 0; i < nt.n_vecplay; ++i) {
@@ -822,10 +1182,9 @@ void CheckPoints::write_tqueue(NrnThread& nt, FileHandler& fh) const {
     TQueue<QTYPE>* tqe = ntd.tqe_;
     TQItem* q;
 
+    // the queue is left as is, the simulation may go on after an interval checkpoint
     fh << -1 << " TQItems from atomic_dq\n";
-    while ((q = tqe->atomic_dq(1e20)) != nullptr) {
-        write_tqueue(q, nt, fh);
-    }
+    tqe->for_each_ordered([&](TQItem* q) { write_tqueue(q, nt, fh); });
     fh << 0 << "\n";
     fh << -1 << " TQItemsfrom binq_\n";
     for (q = tqe->binq_->first(); q; q = tqe->binq_->next(q)) {
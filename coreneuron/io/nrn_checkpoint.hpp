@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include <thread>
+
 #include "coreneuron/io/phase2.hpp"
 
 namespace coreneuron {
@@ -16,7 +18,8 @@ class FileHandler;
 
 class CheckPoints {
   public:
-    CheckPoints(const std::string& save, const std::string& restore);
+    CheckPoints(const std::string& save, const std::string& restore, double interval = 0.);
+    ~CheckPoints();
     std::string get_save_path() const {
         return save_;
     }
@@ -29,30 +32,62 @@ class CheckPoints {
     bool should_restore() const {
         return !restore_.empty();
     }
+    /// the checkpoint to restore was written by --checkpoint-native
+    bool restore_native() const {
+        return restore_native_;
+    }
     double restore_time() const;
-    void write_checkpoint(NrnThread* nt, int nb_threads) const;
+    void write_checkpoint(NrnThread* nt, int nb_threads);
+    /// time of the next interval checkpoint after time, on a min-delay boundary
+    double next_interval_time(double time, double mindelay) const;
+    /// snapshot the state for a native checkpoint that is written in the background
+    void write_interval_checkpoint(NrnThread* nt, int nb_threads);
     /* return true if special checkpoint initialization carried out and
        one should not do finitialize
      */
     bool initialize();
     void restore_tqueue(NrnThread&, const Phase2& p2);
+    /// check that a native checkpoint read by Phase2::read_native fits this setup
+    void check_native(const NrnThread& nt, const std::vector<std::size_t>& layout) const;
 
   private:
+    struct NativeThread;
+
     const std::string save_;
     const std::string restore_;
+    const bool restore_native_;
+    const double interval_;
+    int native_nrank;
+    int native_nthread;
     bool restored;
     int patstim_index;
     double patstim_te;
+    int ninterval;
+    std::thread interval_writer;
+    std::string interval_dir;  // interval checkpoint not completed yet
+    double interval_time;
+
+    void finish_interval_checkpoint();
 
-    void write_time() const;
+    void write_time(const std::string& dir, double time) const;
     void write_phase2(NrnThread& nt) const;
+    void stage_native(NrnThread& nt, NativeThread& s) const;
+    void write_native(const NativeThread& s,
+                      const std::string& dir,
+                      bool parallel_compress = true) const;
+    void write_native_info(const std::string& dir, bool native) const;
+    std::vector<std::size_t> native_layout(const NrnThread& nt) const;
+    template <typename Output>
+    void write_bbcore(NrnThread& nt, Output& out) const;
 
     template <typename T>
     void data_write(FileHandler& F, T* data, int cnt, int sz, int layout, int* permute) const;
     template <typename T>
     T* soa2aos(T* data, int cnt, int sz, int layout, int* permute) const;
-    void write_tqueue(TQItem* q, NrnThread& nt, FileHandler& fh) const;
-    void write_tqueue(NrnThread& nt, FileHandler& fh) const;
+    template <typename Output>
+    void write_tqueue(TQItem* q, NrnThread& nt, Output& fh) const;
+    template <typename Output>
+    void write_tqueue(NrnThread& nt, Output& fh) const;
     void restore_tqitem(int type, std::shared_ptr<Phase2::EventTypeBase> event, NrnThread& nt);
 };
 
@@ -86,6 +121,7 @@ struct Memb_list_chkpnt {
 
 struct NrnThreadChkpnt {
     int file_id;
+    int phase3_chkpnt;  // chkpnt number that the phase 3 file continues from
 
 #if CHKPNTDEBUG
     int nmech;
@@ -7,10 +7,35 @@
 */
 
 #include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "coreneuron/io/nrn_filehandler.hpp"
+#include "coreneuron/io/array_compression.hpp"
+#include "coreneuron/io/dataset_container.hpp"
 #include "coreneuron/nrnconf.h"
+#include "coreneuron/sim/thread_team.hpp"
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 namespace coreneuron {
+namespace {
+// code the chunks of an array in parallel, unless we run on a thread of a job
+bool parallel_codec() {
+#if defined(_OPENMP)
+    return !omp_in_parallel() && !nrn_thread_team_in_job();
+#else
+    return false;
+#endif
+}
+}  // namespace
+
+bool FileHandler::use_mmap = false;
+
 FileHandler::FileHandler(const std::string& filename)
     : chkpnt(0)
     , stored_chkpnt(0) {
@@ -19,18 +44,41 @@ FileHandler::FileHandler(const std::string& filename)
 
 bool FileHandler::file_exist(const std::string& filename) {
     struct stat buffer;
-    return (stat(filename.c_str(), &buffer) == 0);
+    return nrn_dataset_container_has(filename) || (stat(filename.c_str(), &buffer) == 0);
 }
 
 void FileHandler::open(const std::string& filename, std::ios::openmode mode) {
     nrn_assert((mode & (std::ios::in | std::ios::out)));
     close();
+    current_mode = mode;
+    if (mode == std::ios::in) {
+        // files of a packed dataset are read from their container
+        std::vector<char> data;
+        if (nrn_dataset_container_read(filename, data)) {
+            open(filename, std::move(data));
+            return;
+        }
+    }
+    if (use_mmap && mode == std::ios::in) {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+            std::cerr << "cannot open file '" << filename << "'" << std::endl;
+            nrn_assert(false);
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        nrn_assert(p != MAP_FAILED);
+        // the file is parsed front to back, let the kernel read ahead
+        madvise(p, st.st_size, MADV_SEQUENTIAL);
+        open_memory(static_cast<const char*>(p), st.st_size);
+        return;
+    }
     F.open(filename, mode | std::ios::binary);
     if (!F.is_open()) {
         std::cerr << "cannot open file '" << filename << "'" << std::endl;
     }
     nrn_assert(F.is_open());
-    current_mode = mode;
     char version[256];
     if (current_mode & std::ios::in) {
         F.getline(version, sizeof(version));
@@ -42,7 +90,51 @@ void FileHandler::open(const std::string& filename, std::ios::openmode mode) {
     }
 }
 
+void FileHandler::open(const std::string& filename, std::vector<char>&& data) {
+    close();
+    current_mode = std::ios::in;
+    contents = std::move(data);
+    if (contents.empty()) {
+        std::cerr << "empty contents for file '" << filename << "'" << std::endl;
+        nrn_assert(false);
+    }
+    open_memory(contents.data(), contents.size());
+}
+
+void FileHandler::open_memory(const char* data, size_t size) {
+    mapped = data;
+    mapped_size = size;
+    mapped_pos = 0;
+    char version[256];
+    nrn_assert(getline(version, sizeof(version)));
+    check_bbcore_write_version(version);
+}
+
+bool FileHandler::getline(char* buf, size_t size) {
+    if (!mapped) {
+        F.getline(buf, size);
+        return !F.fail();
+    }
+    if (mapped_pos >= mapped_size) {
+        return false;
+    }
+    const char* begin = mapped + mapped_pos;
+    auto end = static_cast<const char*>(memchr(begin, '\n', mapped_size - mapped_pos));
+    size_t len = end ? end - begin : mapped_size - mapped_pos;
+    // like std::istream::getline, a line that does not fit is an error
+    if (len >= size) {
+        return false;
+    }
+    memcpy(buf, begin, len);
+    buf[len] = '\0';
+    mapped_pos += end ? len + 1 : len;
+    return true;
+}
+
 bool FileHandler::eof() {
+    if (mapped) {
+        return mapped_pos >= mapped_size;
+    }
     if (F.eof()) {
         return true;
     }
@@ -57,8 +149,7 @@ bool FileHandler::eof() {
 int FileHandler::read_int() {
     char line_buf[max_line_length];
 
-    F.getline(line_buf, sizeof(line_buf));
-    nrn_assert(!F.fail());
+    nrn_assert(getline(line_buf, sizeof(line_buf)));
 
     int i;
     int n_scan = sscanf(line_buf, "%d", &i);
@@ -70,8 +161,7 @@ int FileHandler::read_int() {
 void FileHandler::read_mapping_count(int* gid, int* nsec, int* nseg, int* nseclist) {
     char line_buf[max_line_length];
 
-    F.getline(line_buf, sizeof(line_buf));
-    nrn_assert(!F.fail());
+    nrn_assert(getline(line_buf, sizeof(line_buf)));
 
     /** mapping file has extra strings, ignore those */
     int n_scan = sscanf(line_buf, "%d %d %d %d", gid, nsec, nseg, nseclist);
@@ -82,26 +172,76 @@ void FileHandler::read_mapping_cell_count(int* count) {
     *count = read_int();
 }
 
-void FileHandler::read_checkpoint_assert() {
+size_t FileHandler::read_checkpoint_assert() {
     char line_buf[max_line_length];
 
-    F.getline(line_buf, sizeof(line_buf));
-    nrn_assert(!F.fail());
+    nrn_assert(getline(line_buf, sizeof(line_buf)));
 
     int i;
-    int n_scan = sscanf(line_buf, "chkpnt %d\n", &i);
-    if (n_scan != 1) {
+    size_t nz = 0;
+    int n_scan = sscanf(line_buf, "chkpnt %d z %zu\n", &i, &nz);
+    if (n_scan < 1) {
         fprintf(stderr, "no chkpnt line for %d\n", chkpnt);
     }
-    nrn_assert(n_scan == 1);
+    nrn_assert(n_scan >= 1);
     if (i != chkpnt) {
         fprintf(stderr, "file chkpnt %d != expected %d\n", i, chkpnt);
     }
     nrn_assert(i == chkpnt);
     ++chkpnt;
+    return nz;
+}
+
+void FileHandler::read_compressed(void* p, size_t nbytes, size_t nz, bool decode) {
+    const char* z;
+    std::vector<char> buf;
+    if (mapped) {
+        nrn_assert(nz <= mapped_size - mapped_pos);
+        z = mapped + mapped_pos;
+        mapped_pos += nz;
+    } else if (!decode) {
+        F.seekg(nz, std::ios_base::cur);
+        nrn_assert(!F.fail());
+        return;
+    } else {
+        buf.resize(nz);
+        F.read(buf.data(), nz);
+        nrn_assert(!F.fail());
+        z = buf.data();
+    }
+    if (decode && !array_compression::decode(z, nz, p, nbytes, parallel_codec())) {
+        fprintf(stderr, "corrupt compressed array at chkpnt %d\n", chkpnt - 1);
+        nrn_assert(false);
+    }
+}
+
+void FileHandler::write_bytes(const char* p, size_t nbytes, size_t item_size, bool delta_encode) {
+    if (compress_arrays && nbytes >= compress_min_bytes) {
+        auto z = array_compression::encode(
+            p, nbytes, item_size, delta_encode, compress_parallel && parallel_codec());
+        if (z.size() < nbytes) {
+            write_checkpoint(z.size());
+            F.write(z.data(), z.size());
+            nrn_assert(!F.fail());
+            return;
+        }
+    }
+    write_checkpoint();
+    F.write(p, nbytes);
+    nrn_assert(!F.fail());
 }
 
 void FileHandler::close() {
+    if (mapped) {
+        if (contents.empty()) {
+            munmap(const_cast<char*>(mapped), mapped_size);
+        } else {
+            std::vector<char>().swap(contents);
+        }
+        mapped = nullptr;
+        mapped_size = 0;
+        mapped_pos = 0;
+    }
     F.close();
 }
 }  // namespace coreneuron
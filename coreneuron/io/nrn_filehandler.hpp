@@ -8,8 +8,10 @@
 
 #pragma once
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#include <type_traits>
 #include <vector>
 #include <sys/stat.h>
 
@@ -29,36 +31,127 @@ namespace coreneuron {
 // @todo: remove this static buffer
 const int max_line_length = 1024;
 
+/** Read-only array of a data file, see FileHandler::map_array().
+ *
+ * When the file is parsed from memory (mmap input or prefetched contents) it
+ * refers to the file and is only valid until the FileHandler is closed. Arrays
+ * follow a text line in the file and need not be aligned, so elements are loaded
+ * with memcpy. Otherwise the array owns its data.
+ */
+template <typename T>
+class MappedArray {
+  public:
+    MappedArray() = default;
+    MappedArray(const char* bytes, size_t count)
+        : bytes_(bytes)
+        , size_(count) {}
+    MappedArray(std::vector<T>&& owned)
+        : owned_(std::move(owned))
+        , bytes_(reinterpret_cast<const char*>(owned_.data()))
+        , size_(owned_.size()) {}
+    MappedArray(MappedArray&&) = default;
+    MappedArray& operator=(MappedArray&&) = default;
+    MappedArray(const MappedArray&) = delete;
+    MappedArray& operator=(const MappedArray&) = delete;
+
+    T operator[](size_t i) const {
+        T value;
+        memcpy(&value, bytes_ + i * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    /** Copy all items to dest, e.g. their final aligned location */
+    void copy_to(T* dest) const {
+        if (size_) {
+            memcpy(dest, bytes_, size_ * sizeof(T));
+        }
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+  private:
+    std::vector<T> owned_;
+    const char* bytes_{};
+    size_t size_{};
+};
+
 class FileHandler {
     std::fstream F;                        //!< File stream associated with reader.
     std::ios_base::openmode current_mode;  //!< File open mode (not stored in fstream)
     int chkpnt;                            //!< Current checkpoint number state.
     int stored_chkpnt;                     //!< last "remembered" checkpoint number state.
+    const char* mapped = nullptr;          //!< File mapping or contents, instead of F.
+    size_t mapped_size = 0;                //!< Size of the mapping in bytes.
+    size_t mapped_pos = 0;                 //!< Read position in the mapping.
+    std::vector<char> contents;            //!< File contents read ahead, mapped points here.
+    bool compress_arrays = false;          //!< Write arrays block compressed.
+    bool compress_parallel = true;         //!< Compress on an OpenMP parallel region if possible.
+
+    /** Parse the file from memory, starting with its version line. */
+    void open_memory(const char* data, size_t size);
+
+    /** Read a line without its newline, from F or the mapping. */
+    bool getline(char* buf, size_t size);
     /** Read a checkpoint line, bump our chkpnt counter, and assert equality.
      *
      * Checkpoint information is represented by a sequence "checkpt %d\n"
      * where %d is a scanf-compatible representation of the checkpoint
-     * integer.
+     * integer. The line of a compressed array is "checkpt %d z %zu\n"
+     * with the size of the encoded array that follows.
+     *
+     * \return size of the compressed array that follows, 0 if it is not compressed
      */
-    void read_checkpoint_assert();
+    size_t read_checkpoint_assert();
+
+    /** Read or skip nz bytes of a compressed array and decode them into nbytes at p. */
+    void read_compressed(void* p, size_t nbytes, size_t nz, bool decode);
+
+    /** Write an array after its checkpoint line, compressed if enabled. */
+    void write_bytes(const char* p, size_t nbytes, size_t item_size, bool delta_encode);
 
     // FileHandler is not copyable.
     FileHandler(const FileHandler&) = delete;
     FileHandler& operator=(const FileHandler&) = delete;
 
   public:
+    /** Map files opened for reading with mmap and parse them in memory. */
+    static bool use_mmap;
+
     FileHandler()
         : chkpnt(0)
         , stored_chkpnt(0) {}
 
     explicit FileHandler(const std::string& filename);
 
+    ~FileHandler() {
+        close();
+    }
+
     /** Preserving chkpnt state, move to a new file. */
     void open(const std::string& filename, std::ios::openmode mode = std::ios::in);
 
+    /** Like open() for reading, but parse the already read contents of filename. */
+    void open(const std::string& filename, std::vector<char>&& data);
+
+    /** Arrays of at least this size are compressed by compress(true). */
+    static constexpr size_t compress_min_bytes = 4096;
+
+    /** Write the arrays of this file block compressed, see array_compression.hpp.
+     *
+     * The reader detects compressed arrays by itself, so this can be chosen per file.
+     * With parallel false the chunks are never compressed on an OpenMP parallel
+     * region, e.g. when writing in the background of a simulation.
+     */
+    void compress(bool on, bool parallel = true) {
+        compress_arrays = on;
+        compress_parallel = parallel;
+    }
+
     /** Is the file not open */
     bool fail() const {
-        return F.fail();
+        return mapped ? false : F.fail();
     }
 
     static bool file_exist(const std::string& filename);
@@ -114,7 +207,7 @@ class FileHandler {
         int nsec, nseg, n_scan;
         char line_buf[max_line_length], name[max_line_length];
 
-        F.getline(line_buf, sizeof(line_buf));
+        getline(line_buf, sizeof(line_buf));
         n_scan = sscanf(line_buf, "%s %d %d", name, &nsec, &nseg);
 
         nrn_assert(n_scan == 3);
@@ -160,7 +253,19 @@ class FileHandler {
         if (count > 0 && flag != seek)
             nrn_assert(p != 0);
 
-        read_checkpoint_assert();
+        size_t nz = read_checkpoint_assert();
+        if (nz) {
+            read_compressed(p, count * sizeof(T), nz, flag == read);
+            return p;
+        }
+        if (mapped) {
+            nrn_assert(count * sizeof(T) <= mapped_size - mapped_pos);
+            if (flag == read && count > 0) {
+                memcpy(p, mapped + mapped_pos, count * sizeof(T));
+            }
+            mapped_pos += count * sizeof(T);
+            return p;
+        }
         switch (flag) {
             case seek:
                 F.seekg(count * sizeof(T), std::ios_base::cur);
@@ -195,6 +300,26 @@ class FileHandler {
         return vec;
     }
 
+    /** Read an array without copying it out of the file mapping, if any.
+     *
+     * The result is valid until the file is closed.
+     */
+    template <typename T>
+    inline MappedArray<T> map_array(size_t count) {
+        if (!mapped) {
+            return MappedArray<T>(read_vector<T>(count));
+        }
+        size_t nz = read_checkpoint_assert();
+        if (nz) {
+            std::vector<T> vec(count);
+            read_compressed(vec.data(), count * sizeof(T), nz, true);
+            return MappedArray<T>(std::move(vec));
+        }
+        nrn_assert(count * sizeof(T) <= mapped_size - mapped_pos);
+        mapped_pos += count * sizeof(T);
+        return MappedArray<T>(mapped + mapped_pos - count * sizeof(T), count);
+    }
+
     /** Close currently open file. */
     void close();
 
@@ -203,9 +328,8 @@ class FileHandler {
     void write_array(T* p, size_t nb_elements) {
         nrn_assert(F.is_open());
         nrn_assert(current_mode & std::ios::out);
-        write_checkpoint();
-        F.write((const char*) p, nb_elements * (sizeof(T)));
-        nrn_assert(!F.fail());
+        write_bytes(
+            (const char*) p, nb_elements * sizeof(T), sizeof(T), std::is_integral<T>::value);
     }
 
     /** Write a padded array. nb_elements is number of elements to write per line,
@@ -218,7 +342,6 @@ class FileHandler {
                      bool to_transpose = false) {
         nrn_assert(F.is_open());
         nrn_assert(current_mode & std::ios::out);
-        write_checkpoint();
         T* temp_cpy = new T[nb_elements * nb_lines];
 
         if (to_transpose) {
@@ -232,8 +355,10 @@ class FileHandler {
         }
         // AoS never use padding, SoA is translated above, so one write
         // operation is enought in both cases
-        F.write((const char*) temp_cpy, nb_elements * sizeof(T) * nb_lines);
-        nrn_assert(!F.fail());
+        write_bytes((const char*) temp_cpy,
+                    nb_elements * sizeof(T) * nb_lines,
+                    sizeof(T),
+                    std::is_integral<T>::value);
         delete[] temp_cpy;
     }
 
@@ -249,8 +374,12 @@ class FileHandler {
   private:
     /* write_checkpoint is callable only for our internal uses, making it accesible to user, makes
      * file format unpredictable */
-    void write_checkpoint() {
-        F << "chkpnt " << chkpnt++ << "\n";
+    void write_checkpoint(size_t nz = 0) {
+        F << "chkpnt " << chkpnt++;
+        if (nz) {
+            F << " z " << nz;
+        }
+        F << "\n";
     }
 };
 }  // namespace coreneuron
@@ -19,6 +19,7 @@
 #include "coreneuron/nrniv/nrniv_decl.h"
 #include "coreneuron/sim/fast_imem.hpp"
 #include "coreneuron/network/multisend.hpp"
+#include "coreneuron/network/neighbor_exchange.hpp"
 #include "coreneuron/utils/nrn_assert.h"
 #include "coreneuron/utils/nrnmutdec.hpp"
 #include "coreneuron/utils/memory.h"
@@ -26,6 +27,9 @@
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/mpi/core/nrnmpi.hpp"
 #include "coreneuron/io/nrn_setup.hpp"
+#include "coreneuron/io/dataset_container.hpp"
+#include "coreneuron/io/group_cost.hpp"
+#include "coreneuron/mechanism/index_compression.hpp"
 #include "coreneuron/network/partrans.hpp"
 #include "coreneuron/io/nrn_checkpoint.hpp"
 #include "coreneuron/permute/node_permute.h"
@@ -41,6 +45,10 @@
 #include "coreneuron/sim/fast_imem.hpp"
 #include "coreneuron/coreneuron.hpp"
 
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
 
 /// --> Coreneuron
 bool corenrn_embedded;
@@ -156,6 +164,7 @@ std::vector<std::map<int, PreSyn*>> neg_gid2out;
 /// Maps for ouput and input presyns
 std::map<int, PreSyn*> gid2out;
 std::map<int, InputPreSyn*> gid2in;
+FlatGidMap<InputPreSyn> gid2in_index;
 
 /// InputPreSyn.nc_index_ to + InputPreSyn.nc_cnt_ give the NetCon*
 std::vector<NetCon*> netcon_in_presyn_order_;
@@ -168,7 +177,7 @@ std::vector<int*> nrnthreads_netcon_srcgid;
 std::vector<std::vector<int>> nrnthreads_netcon_negsrcgid_tid;
 
 /* read files.dat file and distribute cellgroups to all mpi ranks */
-void nrn_read_filesdat(int& ngrp, int*& grp, const char* filesdat) {
+void nrn_read_filesdat(int& ngrp, int*& grp, const char* filesdat, const char* datpath) {
     patstimtype = nrn_get_mechtype("PatternStim");
     if (corenrn_embedded) {
         ngrp = corenrn_embedded_nthread;
@@ -205,21 +214,33 @@ void nrn_read_filesdat(int& ngrp, int*& grp, const char* filesdat) {
             "Info : The number of input datasets are less than ranks, some ranks will be idle!\n");
     }
 
-    ngrp = 0;
-    grp = new int[iNumFiles / nrnmpi_numprocs + 1];
-
-    // irerate over gids in files.dat
+    // irerate over gids in files.dat, a packed dataset gives the container next to the gid
+    std::vector<int> files(iNumFiles);
+    std::vector<int> container_of(iNumFiles, -1);
+    char line[max_line_length];
     for (int iNum = 0; iNum < iNumFiles; ++iNum) {
-        int iFile;
+        nrn_assert(fgets(line, sizeof(line), fp));
+        nrn_assert(sscanf(line, "%d %d", &files[iNum], &container_of[iNum]) >= 1);
+    }
 
-        nrn_assert(fscanf(fp, "%d\n", &iFile) == 1);
-        if ((iNum % nrnmpi_numprocs) == nrnmpi_myid) {
-            grp[ngrp] = iFile;
-            ngrp++;
+    // followed by the list of container files, see dataset_container.hpp
+    int ncontainer = 0;
+    if (fscanf(fp, "containers %d\n", &ncontainer) == 1) {
+        std::vector<std::string> containers(ncontainer);
+        for (auto& name: containers) {
+            nrn_assert(fgets(line, sizeof(line), fp));
+            name = line;
+            name.erase(name.find_last_not_of(" \r\n") + 1);
         }
+        nrn_dataset_containers_open(datpath, containers, files, container_of);
     }
 
     fclose(fp);
+
+    std::vector<int> mine = nrn_group_distribute(files, datpath);
+    ngrp = mine.size();
+    grp = new int[ngrp + 1];
+    std::copy(mine.begin(), mine.end(), grp);
 }
 
 void netpar_tid_gid2ps(int tid, int gid, PreSyn** ps, InputPreSyn** psi) {
@@ -344,6 +365,9 @@ void determine_inputpresyn() {
 
     inputpresyn_.clear();
 
+    // gid2in is complete, build the index used to resolve received spikes
+    gid2in_index.build(gid2in);
+
     // with gid to InputPreSyn and PreSyn maps we can setup the multisend
     // target lists.
     if (use_multisend_) {
@@ -352,6 +376,11 @@ void determine_inputpresyn() {
 #endif
     }
 
+    // and the neighbor spike exchange graph.
+    if (use_neighbor_exchange_) {
+        nrn_neighbor_exchange_setup();
+    }
+
     // fill the netcon_in_presyn_order and recompute nc_cnt_
     // note that not all netcon_in_presyn will be filled if there are netcon
     // with no presyn (ie. nrnthreads_netcon_srcgid[nt.id][i] = -1) but that is ok since they are
@@ -407,9 +436,11 @@ void nrn_setup(const char* filesdat,
                double* mindelay) {
     double time = nrn_wtime();
 
+    FileHandler::use_mmap = corenrn_param.mmap_input;
+
     int ngroup;
     int* gidgroups;
-    nrn_read_filesdat(ngroup, gidgroups, filesdat);
+    nrn_read_filesdat(ngroup, gidgroups, filesdat, datpath);
     UserParams userParams(ngroup,
                           gidgroups,
                           datpath,
@@ -424,6 +455,16 @@ void nrn_setup(const char* filesdat,
     // Note that rank with 0 dataset/cellgroup works fine
     nrn_threads_create(userParams.ngroup <= 1 ? 2 : userParams.ngroup);
 
+    // Start the thread team, with the NrnThreads assigned by predicted cost, before
+    // reading: the phase jobs then allocate and first touch the arrays of each
+    // NrnThread on the (pinned) member that integrates it, i.e. in its NUMA node.
+    nrn_thread_team_init();
+    nrn_group_thread_assign();
+
+    if (corenrn_param.thread_arena) {
+        nrn_thread_arenas_create(nrn_nthread);
+    }
+
     // from nrn_has_net_event create pnttype2presyn for use in phase2.
     auto& memb_func = corenrn.get_memb_funcs();
     auto& pnttype2presyn = corenrn.get_pnttype2presyn();
@@ -473,6 +514,22 @@ void nrn_setup(const char* filesdat,
     // of phase2.  So gap junction setup is deferred to after phase2.
 
     nrnthreads_netcon_negsrcgid_tid.resize(nrn_nthread);
+
+    // With --prefetch-input the files of the next phase are read on a background
+    // thread while the current phase is parsed and populated.
+    bool prefetch = corenrn_param.prefetch_input && !corenrn_embedded;
+    if (prefetch) {
+        // hold two files for each thread that parses them, not all files of the rank
+        int nparse = 1;
+#if defined(_OPENMP)
+        nparse = std::max(1, std::min(userParams.ngroup, omp_get_max_threads()));
+#endif
+        userParams.prefetcher.set_window(2 * nparse,
+                                         std::size_t(corenrn_param.prefetch_window) << 20);
+        coreneuron::prefetch_phase<coreneuron::phase::one>(userParams);
+        coreneuron::prefetch_phase<coreneuron::phase::two>(userParams);
+    }
+
     if (!corenrn_embedded) {
         coreneuron::phase_wrapper<coreneuron::phase::one>(userParams);
     } else {
@@ -488,10 +545,32 @@ void nrn_setup(const char* filesdat,
     // allocate the process wide InputPreSyn array
     determine_inputpresyn();
 
+    if (prefetch && nrn_have_gaps) {
+        coreneuron::prefetch_phase<coreneuron::gap>(userParams);
+    }
+    if (prefetch && is_mapping_needed) {
+        coreneuron::prefetch_phase<coreneuron::phase::three>(userParams);
+    }
+
     // read the rest of the gidgroup's data and complete the setup for each
     // thread.
     /* nrn_multithread_job supports serial, pthread, and openmp. */
+    double phase2_time = nrn_wtime();
     coreneuron::phase_wrapper<coreneuron::phase::two>(userParams, corenrn_embedded);
+    // to compare the restore of native and phase 2 checkpoints, the slowest rank counts
+    if (checkPoints.should_restore()) {
+        phase2_time = nrn_wtime() - phase2_time;
+#if NRNMPI
+        if (corenrn_param.mpi_enable) {
+            phase2_time = nrnmpi_dbl_allreduce(phase2_time, 2);
+        }
+#endif
+        if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+            printf(" Checkpoint data read in %.2lf seconds (%s)\n",
+                   phase2_time,
+                   checkPoints.restore_native() ? "native" : "phase 2");
+        }
+    }
 
     // gap junctions
     // Gaps are done after phase2, in order to use layout and permutation
@@ -518,6 +597,10 @@ void nrn_setup(const char* filesdat,
     if (is_mapping_needed)
         coreneuron::phase_wrapper<coreneuron::phase::three>(userParams);
 
+    // all data files have been read
+    userParams.prefetcher.stop();
+    nrn_dataset_containers_close();
+
     *mindelay = set_mindelay(*mindelay);
 
     if (run_setup_cleanup)  // if run_setup_cleanup==false, user must call nrn_setup_cleanup() later
@@ -533,6 +616,14 @@ void nrn_setup(const char* filesdat,
     /// Allocate memory for fast_imem calculation
     nrn_fast_imem_alloc();
 
+    /// 16 bit index arrays with --index-compression
+    if (corenrn_param.index_compression && !corenrn_param.gpu) {
+        nrn_multithread_job([](NrnThread* nt) {
+            NrnThreadArenaScope arena(nt->id);
+            nrn_compress_indices(nt);
+        });
+    }
+
     /// Generally, tables depend on a few parameters. And if those parameters change,
     /// then the table needs to be recomputed. This is obviously important in NEURON
     /// since the user can change those parameters at any time. However, there is no
@@ -717,6 +808,7 @@ void nrn_cleanup() {
         delete psi.second;
     }
     gid2in.clear();
+    gid2in_index.clear();
     gid2out.clear();
 
     // clean nrnthread_chkpnt
@@ -744,6 +836,7 @@ void nrn_cleanup() {
             ml->pdata = nullptr;
             free_memory(ml->nodeindices);
             ml->nodeindices = nullptr;
+            nrn_free_compressed_indices(ml);
             if (ml->_permute) {
                 delete[] ml->_permute;
                 ml->_permute = nullptr;
@@ -839,6 +932,13 @@ void nrn_cleanup() {
         if (nt->netcons) {
             delete[] nt->netcons;
             nt->netcons = nullptr;
+            free_memory(nt->netcon_delay);
+            nt->netcon_delay = nullptr;
+            free_memory(nt->netcon_target);
+            nt->netcon_target = nullptr;
+            free_memory(nt->netcon_weight_index);
+            nt->netcon_weight_index = nullptr;
+            nrn_free_compressed_indices(nt);
         }
 
         if (nt->weights) {
@@ -883,6 +983,10 @@ void nrn_cleanup() {
     nrn_multisend_cleanup();
 #endif
 
+    if (use_neighbor_exchange_) {
+        nrn_neighbor_exchange_cleanup();
+    }
+
     netcon_in_presyn_order_.clear();
 
     nrn_threads_free();
@@ -894,6 +998,9 @@ void nrn_cleanup() {
     destroy_interleave_info();
 
     nrn_partrans::gap_cleanup();
+
+    // last, everything allocated from the arenas has been "freed" above
+    nrn_thread_arenas_free();
 }
 
 void delete_trajectory_requests(NrnThread& nt) {
@@ -925,6 +1032,8 @@ void read_phase2(NrnThread& nt, UserParams& userParams) {
     Phase2 p2;
     if (corenrn_embedded) {
         p2.read_direct(nt.id, nt);
+    } else if (userParams.checkPoints.restore_native()) {
+        p2.read_native(userParams.file_reader[nt.id], nt);
     } else {
         p2.read_file(userParams.file_reader[nt.id], nt);
     }
@@ -1038,18 +1147,28 @@ size_t input_presyn_size(void) {
     }
     size_t nbyte = sizeof(gid2in) + sizeof(int) * gid2in.size() +
                    sizeof(InputPreSyn*) * gid2in.size();
+    nbyte += sizeof(gid2in_index) + gid2in_index.nbytes();
 #ifdef DEBUG
     printf(" gid2in table bytes=~%ld size=%ld\n", nbyte, gid2in.size());
 #endif
     return nbyte;
 }
 
+// NetCon as it was before its data moved to the NrnThread arrays, for the memory report
+struct NetConObjectLayout: DiscreteEvent {
+    bool active;
+    double delay;
+    Point_process* target;
+    int weight_index;
+};
+
 size_t model_size(bool detailed_report) {
     long nbyte = 0;
     size_t sz_nrnThread = sizeof(NrnThread);
     size_t sz_presyn = sizeof(PreSyn);
     size_t sz_input_presyn = sizeof(InputPreSyn);
-    size_t sz_netcon = sizeof(NetCon);
+    // the NetCon handle and its data in the arrays of the NrnThread
+    size_t sz_netcon = sizeof(NetCon) + sizeof(double) + 2 * sizeof(int);
     size_t sz_pntproc = sizeof(Point_process);
     size_t nccnt = 0;
 
@@ -1238,6 +1357,9 @@ size_t model_size(bool detailed_report) {
                    global_size_data_min[12],
                    global_size_data_max[12],
                    global_size_data_avg[12]);
+            printf("NetCon memory per synapse: %ld bytes (%ld with the data in the objects)\n",
+                   sz_netcon,
+                   sizeof(NetConObjectLayout));
         }
     }
 
@@ -15,6 +15,7 @@
 #include "coreneuron/io/user_params.hpp"
 #include "coreneuron/io/mem_layout_util.hpp"
 #include "coreneuron/io/nrn_checkpoint.hpp"
+#include "coreneuron/utils/thread_arena.hpp"
 
 namespace coreneuron {
 void read_phase1(NrnThread& nt, UserParams& userParams);
@@ -100,23 +101,41 @@ inline void read_phase_aux<gap>(NrnThread& nt, UserParams& userParams) {
     read_phasegap(nt, userParams);
 }
 
+/// Data file of phase P of group i
+template <phase P>
+inline std::string phase_file_name(const UserParams& userParams, int i) {
+    // directory to read could be different for phase 2 if we are restoring
+    // all other phases still read from dataset directory because the data
+    // is constant
+    const char* data_dir = P == two ? userParams.restore_path : userParams.path;
+    // a native checkpoint replaces the phase 2 file
+    std::string name = P == two && userParams.checkPoints.restore_native() ? "native"
+                                                                             : getPhaseName<P>();
+    return std::string(data_dir) + "/" + std::to_string(userParams.gidgroups[i]) + "_" + name +
+           ".dat";
+}
+
+/// Queue the phase P files of all groups on the background reader
+template <phase P>
+inline void prefetch_phase(UserParams& userParams) {
+    std::vector<std::string> files;
+    for (int i = 0; i < userParams.ngroup; ++i) {
+        files.push_back(phase_file_name<P>(userParams, i));
+    }
+    userParams.prefetcher.queue(files);
+}
+
 /// Reading phase wrapper for each neuron group.
 template <phase P>
 inline void* phase_wrapper_w(NrnThread* nt, UserParams& userParams, bool in_memory_transfer) {
     int i = nt->id;
+    // model data read by this job lives as long as the NrnThread (--thread-arena)
+    NrnThreadArenaScope arena(i);
     if (i < userParams.ngroup) {
         if (!in_memory_transfer) {
-            const char* data_dir = userParams.path;
-            // directory to read could be different for phase 2 if we are restoring
-            // all other phases still read from dataset directory because the data
-            // is constant
-            if (P == 2) {
-                data_dir = userParams.restore_path;
-            }
-
-            std::string fname = std::string(data_dir) + "/" +
-                                std::to_string(userParams.gidgroups[i]) + "_" + getPhaseName<P>() +
-                                ".dat";
+            std::string fname = phase_file_name<P>(userParams, i);
+            // contents of the file, if it was read ahead by the background reader
+            std::vector<char> contents;
 
             // Avoid trying to open the gid_gap.dat file if it doesn't exist when there are no
             // gap junctions in this gid.
@@ -124,7 +143,9 @@ inline void* phase_wrapper_w(NrnThread* nt, UserParams& userParams, bool in_memo
             // because files are opened in the order of `gid_1.dat`, `gid_2.dat` and `gid_gap.dat`.
             // When we open next file, `gid_gap.dat` in this case, we are supposed to close the
             // handle for `gid_2.dat` even though file doesn't exist.
-            if (P == gap && !FileHandler::file_exist(fname)) {
+            if (userParams.prefetcher.take(fname, contents)) {
+                userParams.file_reader[i].open(fname, std::move(contents));
+            } else if (P == gap && !FileHandler::file_exist(fname)) {
                 userParams.file_reader[i].close();
             } else {
                 // if no file failed to open or not opened at all
@@ -67,6 +67,13 @@ void Phase1::populate(NrnThread& nt, OMP_Mutex& mut) {
     coreneuron::nrnthreads_netcon_negsrcgid_tid[nt.id] = this->netcon_negsrcgid_tid;
 
     nt.netcons = new NetCon[nt.n_netcon];
+    nt.netcon_delay = (double*) ecalloc_align(nt.n_netcon, sizeof(double));
+    nt.netcon_target = (int*) ecalloc_align(nt.n_netcon, sizeof(int));
+    nt.netcon_weight_index = (int*) ecalloc_align(nt.n_netcon, sizeof(int));
+    for (int i = 0; i < nt.n_netcon; ++i) {
+        nt.netcons[i].bind(nt.id, i);
+        nt.netcon_target[i] = -1;  // set in phase2 if the NetCon has a target
+    }
 
     if (nt.n_presyn) {
         nt.presyns_helper = (PreSynHelper*) ecalloc_align(nt.n_presyn, sizeof(PreSynHelper));
@@ -19,10 +19,6 @@
 #include "coreneuron/io/mem_layout_util.hpp"
 #include "coreneuron/io/setup_fornetcon.hpp"
 
-#if defined(_OPENMP)
-#include <omp.h>
-#endif
-
 int (*nrn2core_get_dat2_1_)(int tid,
                             int& n_real_cell,
                             int& ngid,
@@ -132,20 +128,7 @@ void Phase2::read_file(FileHandler& F, const NrnThread& nt) {
 
     int n_data_padded = nrn_soa_padded_size(n_node, SOA_LAYOUT);
     {
-        {  // Compute size of _data and allocate
-            int n_data = 6 * n_data_padded;
-            if (n_diam > 0) {
-                n_data += n_data_padded;
-            }
-            for (int i = 0; i < n_mech; ++i) {
-                int layout = corenrn.get_mech_data_layout()[mech_types[i]];
-                int n = nodecounts[i];
-                int sz = corenrn.get_prop_param_size()[mech_types[i]];
-                n_data = nrn_soa_byte_align(n_data);
-                n_data += nrn_soa_padded_size(n, layout) * sz;
-            }
-            _data = (double*) ecalloc_align(n_data, sizeof(double));
-        }
+        _data = (double*) ecalloc_align(data_size(), sizeof(double));
         F.read_array<double>(_data + 2 * n_data_padded, n_node);
         F.read_array<double>(_data + 3 * n_data_padded, n_node);
         F.read_array<double>(_data + 5 * n_data_padded, n_node);
@@ -165,17 +148,17 @@ void Phase2::read_file(FileHandler& F, const NrnThread& nt) {
         int sz = corenrn.get_prop_param_size()[mech_types[i]];
         int dsz = corenrn.get_prop_dparam_size()[mech_types[i]];
         offset = nrn_soa_byte_align(offset);
-        std::vector<int> nodeindices;
+        MappedArray<int> nodeindices;
         if (!corenrn.get_is_artificial()[mech_types[i]]) {
-            nodeindices = F.read_vector<int>(n);
+            nodeindices = F.map_array<int>(n);
         }
         F.read_array<double>(_data + offset, sz * n);
         offset += nrn_soa_padded_size(n, layout) * sz;
-        std::vector<int> pdata;
+        MappedArray<int> pdata;
         if (dsz > 0) {
-            pdata = F.read_vector<int>(dsz * n);
+            pdata = F.map_array<int>(dsz * n);
         }
-        tmls.emplace_back(TML{nodeindices, pdata, mech_types[i], {}, {}});
+        tmls.emplace_back(TML{std::move(nodeindices), std::move(pdata), mech_types[i], {}, {}});
         if (dsz > 0) {
             int sz = F.read_int();
             if (sz) {
@@ -186,27 +169,43 @@ void Phase2::read_file(FileHandler& F, const NrnThread& nt) {
     }
     output_vindex = F.read_vector<int>(nt.n_presyn);
     output_threshold = F.read_vector<double>(n_real_output);
-    pnttype = F.read_vector<int>(nt.n_netcon);
-    pntindex = F.read_vector<int>(nt.n_netcon);
-    weights = F.read_vector<double>(n_weight);
-    delay = F.read_vector<double>(nt.n_netcon);
+    pnttype = F.map_array<int>(nt.n_netcon);
+    pntindex = F.map_array<int>(nt.n_netcon);
+    weights = F.map_array<double>(n_weight);
+    delay = F.map_array<double>(nt.n_netcon);
     num_point_process = F.read_int();
+    read_bbcore_arrays(F);
+    read_vec_play(F);
+
+    // store current checkpoint state to continue reading mapping
+    // The checkpoint numbering in phase 3 is a continuing of phase 2, and so will be restored
+    F.record_checkpoint();
+    phase3_chkpnt = F.checkpoint();
+
+    if (F.eof())
+        return;
+
+    read_tqueue(F, nt);
+}
 
+// Size of _data: the node arrays followed by the data of every mechanism
+std::size_t Phase2::data_size() const {
+    std::size_t n_data_padded = nrn_soa_padded_size(n_node, SOA_LAYOUT);
+    std::size_t n_data = 6 * n_data_padded;
+    if (n_diam > 0) {
+        n_data += n_data_padded;
+    }
     for (int i = 0; i < n_mech; ++i) {
-        if (!corenrn.get_bbcore_read()[mech_types[i]]) {
-            continue;
-        }
-        tmls[i].type = F.read_int();
-        int icnt = F.read_int();
-        int dcnt = F.read_int();
-        if (icnt > 0) {
-            tmls[i].iArray = F.read_vector<int>(icnt);
-        }
-        if (dcnt > 0) {
-            tmls[i].dArray = F.read_vector<double>(dcnt);
-        }
+        int layout = corenrn.get_mech_data_layout()[mech_types[i]];
+        int n = nodecounts[i];
+        int sz = corenrn.get_prop_param_size()[mech_types[i]];
+        n_data = nrn_soa_byte_align(n_data);
+        n_data += nrn_soa_padded_size(n, layout) * sz;
     }
+    return n_data;
+}
 
+void Phase2::read_vec_play(FileHandler& F) {
     int n_vec_play_continuous = F.read_int();
     vec_play_continuous.reserve(n_vec_play_continuous);
     for (int i = 0; i < n_vec_play_continuous; ++i) {
@@ -221,14 +220,101 @@ void Phase2::read_file(FileHandler& F, const NrnThread& nt) {
         F.read_array<double>(item.tvec.data(), sz);
         vec_play_continuous.push_back(std::move(item));
     }
+}
 
-    // store current checkpoint state to continue reading mapping
-    // The checkpoint numbering in phase 3 is a continuing of phase 2, and so will be restored
+// A native checkpoint holds the arrays of the thread as they are in memory, so
+// that populate only copies them, see CheckPoints::stage_native for the format.
+// The phase 1 file of the dataset is read as usual.
+void Phase2::read_native(FileHandler& F, const NrnThread& nt) {
+    native = true;
+    F.checkpoint(2);
+    std::size_t n = F.read_int();
+    native_layout = F.read_vector<std::size_t>(n);
+    phase3_chkpnt = F.read_int();
+    n_real_cell = F.read_int();
+    n_real_output = F.read_int();
+    n_node = F.read_int();
+    n_diam = F.read_int();
+    n_mech = F.read_int();
+    mech_types = std::vector<int>(n_mech, 0);
+    nodecounts = std::vector<int>(n_mech, 0);
+    for (int i = 0; i < n_mech; ++i) {
+        mech_types[i] = F.read_int();
+        nodecounts[i] = F.read_int();
+    }
+    check_mechanism();
+    n_idata = F.read_int();
+    n_vdata = F.read_int();
+    int n_weight = F.read_int();
+
+    v_parent_index = (int*) ecalloc_align(n_node, sizeof(int));
+    F.read_array<int>(v_parent_index, n_node);
+    if (F.read_int()) {
+        permute = F.read_vector<int>(n_node);
+    }
+    std::size_t n_data = data_size();
+    _data = (double*) ecalloc_align(n_data, sizeof(double));
+    F.read_array<double>(_data, n_data);
+    for (int i = 0; i < n_mech; ++i) {
+        int layout = corenrn.get_mech_data_layout()[mech_types[i]];
+        int dsz = corenrn.get_prop_dparam_size()[mech_types[i]];
+        auto nodeindices = F.map_array<int>(nodecounts[i]);
+        std::vector<int> ml_permute;
+        if (F.read_int()) {
+            ml_permute = F.read_vector<int>(nodecounts[i]);
+        }
+        MappedArray<int> pdata;
+        if (dsz > 0) {
+            pdata = F.map_array<int>(std::size_t(nrn_soa_padded_size(nodecounts[i], layout)) *
+                                     dsz);
+        }
+        tmls.emplace_back(TML{std::move(nodeindices),
+                              std::move(pdata),
+                              mech_types[i],
+                              {},
+                              {},
+                              {},
+                              std::move(ml_permute)});
+    }
+    output_vindex = F.read_vector<int>(nt.n_presyn);
+    output_threshold = F.read_vector<double>(n_real_output);
+    netcon_target = F.map_array<int>(nt.n_netcon);
+    netcon_weight_index = F.map_array<int>(nt.n_netcon);
+    delay = F.map_array<double>(nt.n_netcon);
+    weights = F.map_array<double>(n_weight);
+    read_vec_play(F);
+
+    // BBCOREPOINTER data and event queue as in a phase2 checkpoint
+    num_point_process = F.read_int();
+    read_bbcore_arrays(F);
+    read_tqueue(F, nt);
+
+    // the phase 3 file continues the numbering of the phase 2 file of the dataset
+    F.checkpoint(phase3_chkpnt);
     F.record_checkpoint();
+}
 
-    if (F.eof())
-        return;
+void Phase2::read_bbcore_arrays(FileHandler& F) {
+    for (int i = 0; i < n_mech; ++i) {
+        if (!corenrn.get_bbcore_read()[mech_types[i]]) {
+            continue;
+        }
+        tmls[i].type = F.read_int();
+        int icnt = F.read_int();
+        int dcnt = F.read_int();
+        tmls[i].iArray.clear();
+        tmls[i].dArray.clear();
+        if (icnt > 0) {
+            tmls[i].iArray = F.read_vector<int>(icnt);
+        }
+        if (dcnt > 0) {
+            tmls[i].dArray = F.read_vector<double>(dcnt);
+        }
+    }
+}
 
+void Phase2::read_tqueue(FileHandler& F, const NrnThread& nt) {
+    int n_vec_play_continuous = vec_play_continuous.size();
     nrn_assert(F.read_int() == n_vec_play_continuous);
 
     for (int i = 0; i < n_vec_play_continuous; ++i) {
@@ -317,14 +403,15 @@ void Phase2::read_direct(int thread_id, const NrnThread& nt) {
 
         tml.type = type;
         // artificial cell don't use nodeindices
+        std::vector<int> nodeindices;
         if (!corenrn.get_is_artificial()[type]) {
-            tml.nodeindices.resize(nodecounts[i]);
+            nodeindices.resize(nodecounts[i]);
         }
-        tml.pdata.resize(nodecounts[i] * dparam_sizes[type]);
+        std::vector<int> pdata(nodecounts[i] * dparam_sizes[type]);
 
         int* nodeindices_ = nullptr;
         double* data_ = _data + offset;
-        int* pdata_ = const_cast<int*>(tml.pdata.data());
+        int* pdata_ = pdata.data();
         (*nrn2core_get_dat2_mech_)(thread_id,
                                    i,
                                    dparam_sizes[type] > 0 ? dsz_inst : 0,
@@ -336,9 +423,11 @@ void Phase2::read_direct(int thread_id, const NrnThread& nt) {
             dsz_inst++;
         offset += nrn_soa_padded_size(nodecounts[i], layout) * param_sizes[type];
         if (nodeindices_) {
-            std::copy(nodeindices_, nodeindices_ + nodecounts[i], tml.nodeindices.data());
+            std::copy(nodeindices_, nodeindices_ + nodecounts[i], nodeindices.data());
             free(nodeindices_);  // not free_memory because this is allocated by NEURON?
         }
+        tml.nodeindices = std::move(nodeindices);
+        tml.pdata = std::move(pdata);
         if (corenrn.get_is_artificial()[type]) {
             assert(nodeindices_ == nullptr);
         }
@@ -789,19 +878,22 @@ void Phase2::handle_weights(NrnThread& nt, int n_netcon, NrnThreadChkpnt& ntc) {
     nt.n_weight = weights.size();
     // weights in netcons order in groups defined by Point_process target type.
     nt.weights = (double*) ecalloc_align(nt.n_weight, sizeof(double));
-    std::copy(weights.begin(), weights.end(), nt.weights);
-
-    int iw = 0;
-    for (int i = 0; i < n_netcon; ++i) {
-        NetCon& nc = nt.netcons[i];
-        nc.u.weight_index_ = iw;
-        if (pnttype[i] != 0) {
-            iw += corenrn.get_pnt_receive_size()[pnttype[i]];
-        } else {
-            iw += 1;
+    weights.copy_to(nt.weights);
+
+    if (native) {
+        netcon_weight_index.copy_to(nt.netcon_weight_index);
+    } else {
+        int iw = 0;
+        for (int i = 0; i < n_netcon; ++i) {
+            nt.netcon_weight_index[i] = iw;
+            if (pnttype[i] != 0) {
+                iw += corenrn.get_pnt_receive_size()[pnttype[i]];
+            } else {
+                iw += 1;
+            }
         }
+        assert(iw == nt.n_weight);
     }
-    assert(iw == nt.n_weight);
 
     // Nontrivial if FOR_NETCON in use by some mechanisms
     setup_fornetcon_info(nt);
@@ -809,12 +901,9 @@ void Phase2::handle_weights(NrnThread& nt, int n_netcon, NrnThreadChkpnt& ntc) {
 
 #if CHKPNTDEBUG
     ntc.delay = new double[n_netcon];
-    memcpy(ntc.delay, delay.data(), n_netcon * sizeof(double));
+    delay.copy_to(ntc.delay);
 #endif
-    for (int i = 0; i < n_netcon; ++i) {
-        NetCon& nc = nt.netcons[i];
-        nc.delay_ = delay[i];
-    }
+    delay.copy_to(nt.netcon_delay);
 }
 
 void Phase2::get_info_from_bbcore(NrnThread& nt,
@@ -903,9 +992,11 @@ void Phase2::set_vec_play(NrnThread& nt, NrnThreadChkpnt& ntc) {
         ntc.vecplay_ix[i] = vecPlay.ix;
 #endif
 
-        vecPlay.ix = nrn_param_layout(vecPlay.ix, vecPlay.mtype, ml);
-        if (ml->_permute) {
-            vecPlay.ix = nrn_index_permute(vecPlay.ix, vecPlay.mtype, ml);
+        if (!native) {  // a native checkpoint has the index into ml->data
+            vecPlay.ix = nrn_param_layout(vecPlay.ix, vecPlay.mtype, ml);
+            if (ml->_permute) {
+                vecPlay.ix = nrn_index_permute(vecPlay.ix, vecPlay.mtype, ml);
+            }
         }
         nt._vecplay[i] = new VecPlayContinuous(ml->data + vecPlay.ix,
                                                std::move(vecPlay.yvec),
@@ -915,9 +1006,199 @@ void Phase2::set_vec_play(NrnThread& nt, NrnThreadChkpnt& ntc) {
     }
 }
 
+// Transform the mechanism data and pdata of the dataset to their layout and
+// offsets in nt._data, then apply the node and mechanism permutation if requested.
+void Phase2::transform_dataset(NrnThread& nt,
+                               const std::vector<Memb_func>& memb_func,
+                               std::vector<int>& pnt_offset) {
+#if CHKPNTDEBUG
+    NrnThreadChkpnt& ntc = nrnthread_chkpnt[nt.id];
+#endif
+    auto& nrn_prop_param_size_ = corenrn.get_prop_param_size();
+    auto& nrn_prop_dparam_size_ = corenrn.get_prop_dparam_size();
+    int synoffset = 0;
+
+    // All the mechanism data and pdata.
+    // Also fill in the pnt_offset
+    // Complete spec of Point_process except for the acell presyn_ field.
+    int itml = 0;
+    for (auto tml = nt.tml; tml; tml = tml->next, ++itml) {
+        int type = tml->index;
+        Memb_list* ml = tml->ml;
+        int n = ml->nodecount;
+        int szp = nrn_prop_param_size_[type];
+        int szdp = nrn_prop_dparam_size_[type];
+        int layout = corenrn.get_mech_data_layout()[type];
+
+        ml->nodeindices = (int*) ecalloc_align(ml->nodecount, sizeof(int));
+        tmls[itml].nodeindices.copy_to(ml->nodeindices);
+
+        mech_data_layout_transform<double>(ml->data, n, szp, layout);
+
+        if (szdp) {
+            ml->pdata = (int*) ecalloc_align(nrn_soa_padded_size(n, layout) * szdp, sizeof(int));
+            tmls[itml].pdata.copy_to(ml->pdata);
+            mech_data_layout_transform<int>(ml->pdata, n, szdp, layout);
+
+#if CHKPNTDEBUG  // Not substantive. Only for debugging.
+            Memb_list_chkpnt* mlc = ntc.mlmap[type];
+            mlc->pdata_not_permuted = (int*) coreneuron::ecalloc_align(n * szdp, sizeof(int));
+            if (layout == Layout::AoS) {  // only copy
+                for (int i = 0; i < n; ++i) {
+                    for (int j = 0; j < szdp; ++j) {
+                        mlc->pdata_not_permuted[i * szdp + j] = ml->pdata[i * szdp + j];
+                    }
+                }
+            } else if (layout == Layout::SoA) {  // transpose and unpad
+                int align_cnt = nrn_soa_padded_size(n, layout);
+                for (int i = 0; i < n; ++i) {
+                    for (int j = 0; j < szdp; ++j) {
+                        mlc->pdata_not_permuted[i * szdp + j] = ml->pdata[i + j * align_cnt];
+                    }
+                }
+            }
+#endif
+        } else {
+            ml->pdata = nullptr;
+        }
+        if (corenrn.get_pnt_map()[type] > 0) {  // POINT_PROCESS mechanism including acell
+            int cnt = ml->nodecount;
+            Point_process* pnt = nullptr;
+            pnt = nt.pntprocs + synoffset;
+            pnt_offset[type] = synoffset;
+            synoffset += cnt;
+            for (int i = 0; i < cnt; ++i) {
+                Point_process* pp = pnt + i;
+                pp->_type = type;
+                pp->_i_instance = i;
+                nt._vdata[ml->pdata[nrn_i_layout(i, cnt, 1, szdp, layout)]] = pp;
+                pp->_tid = nt.id;
+            }
+        }
+    }
+
+    pdata_relocation(nt, memb_func);
+
+    /* if desired, apply the node permutation. This involves permuting
+       at least the node parameter arrays for a, b, and area (and diam) and all
+       integer vector values that index into nodes. This could have been done
+       when originally filling the arrays with AoS ordered data, but can also
+       be done now, after the SoA transformation. The latter has the advantage
+       that the present order is consistent with all the layout values. Note
+       that after this portion of the permutation, a number of other node index
+       vectors will be read and will need to be permuted as well in subsequent
+       sections of this function.
+    */
+    if (interleave_permute_type) {
+        nt._permute = interleave_order(nt.id, nt.ncell, nt.end, nt._v_parent_index);
+    }
+    if (nt._permute) {
+        int* p = nt._permute;
+        permute_data(nt._actual_a, nt.end, p);
+        permute_data(nt._actual_b, nt.end, p);
+        permute_data(nt._actual_area, nt.end, p);
+        permute_data(nt._actual_v,
+                     nt.end,
+                     p);  // need if restore or finitialize does not initialize voltage
+        if (nt._actual_diam) {
+            permute_data(nt._actual_diam, nt.end, p);
+        }
+        // index values change as well as ordering
+        permute_ptr(nt._v_parent_index, nt.end, p);
+        node_permute(nt._v_parent_index, nt.end, p);
+
+#if CORENRN_DEBUG
+        for (int i = 0; i < nt.end; ++i) {
+            printf("parent[%d] = %d\n", i, nt._v_parent_index[i]);
+        }
+#endif
+
+        // specify the ml->_permute and sort the nodeindices
+        // Have to calculate all the permute before updating pdata in case
+        // POINTER to data of other mechanisms exist.
+        for (auto tml = nt.tml; tml; tml = tml->next) {
+            if (tml->ml->nodeindices) {  // not artificial
+                permute_nodeindices(tml->ml, p);
+            }
+        }
+        for (auto tml = nt.tml; tml; tml = tml->next) {
+            if (tml->ml->nodeindices) {  // not artificial
+                permute_ml(tml->ml, tml->index, nt);
+            }
+        }
+
+        // permute the Point_process._i_instance
+        for (int i = 0; i < nt.n_pntproc; ++i) {
+            Point_process& pp = nt.pntprocs[i];
+            Memb_list* ml = nt._ml_list[pp._type];
+            if (ml->_permute) {
+                pp._i_instance = ml->_permute[pp._i_instance];
+            }
+        }
+    }
+}
+
+// The arrays of a native checkpoint are already permuted, in their layout and
+// relocated, so they are only copied. Also fill in the pnt_offset.
+void Phase2::set_native_data(NrnThread& nt, std::vector<int>& pnt_offset) {
+    int synoffset = 0;
+    int itml = 0;
+    for (auto tml = nt.tml; tml; tml = tml->next, ++itml) {
+        int type = tml->index;
+        Memb_list* ml = tml->ml;
+        int n = ml->nodecount;
+        int szdp = corenrn.get_prop_dparam_size()[type];
+        int layout = corenrn.get_mech_data_layout()[type];
+
+        ml->nodeindices = (int*) ecalloc_align(n, sizeof(int));
+        tmls[itml].nodeindices.copy_to(ml->nodeindices);
+        const auto& ml_permute = tmls[itml].permute;
+        if (!ml_permute.empty()) {
+            ml->_permute = new int[n];
+            std::copy(ml_permute.begin(), ml_permute.end(), ml->_permute);
+        }
+        if (szdp) {
+            ml->pdata = (int*) ecalloc_align(nrn_soa_padded_size(n, layout) * szdp, sizeof(int));
+            tmls[itml].pdata.copy_to(ml->pdata);
+        } else {
+            ml->pdata = nullptr;
+        }
+        if (corenrn.get_pnt_map()[type] > 0) {  // POINT_PROCESS mechanism including acell
+            Point_process* pnt = nt.pntprocs + synoffset;
+            pnt_offset[type] = synoffset;
+            synoffset += n;
+            for (int i = 0; i < n; ++i) {
+                Point_process* pp = pnt + i;
+                pp->_type = type;
+                pp->_i_instance = ml->_permute ? ml->_permute[i] : i;
+                nt._vdata[ml->pdata[nrn_i_layout(pp->_i_instance, n, 1, szdp, layout)]] = pp;
+                pp->_tid = nt.id;
+            }
+        }
+    }
+
+    if (!permute.empty()) {
+        nt._permute = new int[nt.end];
+        std::copy(permute.begin(), permute.end(), nt._permute);
+        // The solver needs the InterleaveInfo, which comes with the node order of
+        // the cells. Set it up from the parents in the original order.
+        int* pinv = inverse_permute(nt._permute, nt.end);
+        std::vector<int> parent(nt.end);
+        for (int i = 0; i < nt.end; ++i) {
+            int x = nt._v_parent_index[nt._permute[i]];
+            parent[i] = x >= 0 ? pinv[x] : 0;
+        }
+        delete[] pinv;
+        int* order = interleave_order(nt.id, nt.ncell, nt.end, parent.data());
+        nrn_assert(order && std::equal(order, order + nt.end, nt._permute));
+        delete[] order;
+    }
+}
+
 void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
     NrnThreadChkpnt& ntc = nrnthread_chkpnt[nt.id];
     ntc.file_id = userParams.gidgroups[nt.id];
+    ntc.phase3_chkpnt = phase3_chkpnt;
 
     nt.ncell = n_real_cell;
     nt.end = n_node;
@@ -940,19 +1221,11 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
     }
 #endif
 
-    nt.stream_id = 0;
+    // one stream per NrnThread, populate also runs on the thread team, whose members
+    // are not OpenMP threads
+    nt.stream_id = nt.id;
     nt.compute_gpu = 0;
     auto& nrn_prop_param_size_ = corenrn.get_prop_param_size();
-    auto& nrn_prop_dparam_size_ = corenrn.get_prop_dparam_size();
-
-/* read_phase2 is being called from openmp region
- * and hence we can set the stream equal to current thread id.
- * In fact we could set gid as stream_id when we will have nrn threads
- * greater than number of omp threads.
- */
-#if defined(_OPENMP)
-    nt.stream_id = omp_get_thread_num();
-#endif
 
     int shadow_rhs_cnt = 0;
     nt.shadow_rhs_cnt = 0;
@@ -1053,132 +1326,17 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
     memcpy(ntc.area, nt._actual_area, nt.end * sizeof(double));
 #endif
 
-    int synoffset = 0;
     std::vector<int> pnt_offset(memb_func.size());
-
-    // All the mechanism data and pdata.
-    // Also fill in the pnt_offset
-    // Complete spec of Point_process except for the acell presyn_ field.
-    int itml = 0;
-    for (auto tml = nt.tml; tml; tml = tml->next, ++itml) {
-        int type = tml->index;
-        Memb_list* ml = tml->ml;
-        int n = ml->nodecount;
-        int szp = nrn_prop_param_size_[type];
-        int szdp = nrn_prop_dparam_size_[type];
-        int layout = corenrn.get_mech_data_layout()[type];
-
-        ml->nodeindices = (int*) ecalloc_align(ml->nodecount, sizeof(int));
-        std::copy(tmls[itml].nodeindices.begin(), tmls[itml].nodeindices.end(), ml->nodeindices);
-
-        mech_data_layout_transform<double>(ml->data, n, szp, layout);
-
-        if (szdp) {
-            ml->pdata = (int*) ecalloc_align(nrn_soa_padded_size(n, layout) * szdp, sizeof(int));
-            std::copy(tmls[itml].pdata.begin(), tmls[itml].pdata.end(), ml->pdata);
-            mech_data_layout_transform<int>(ml->pdata, n, szdp, layout);
-
-#if CHKPNTDEBUG  // Not substantive. Only for debugging.
-            Memb_list_chkpnt* mlc = ntc.mlmap[type];
-            mlc->pdata_not_permuted = (int*) coreneuron::ecalloc_align(n * szdp, sizeof(int));
-            if (layout == Layout::AoS) {  // only copy
-                for (int i = 0; i < n; ++i) {
-                    for (int j = 0; j < szdp; ++j) {
-                        mlc->pdata_not_permuted[i * szdp + j] = ml->pdata[i * szdp + j];
-                    }
-                }
-            } else if (layout == Layout::SoA) {  // transpose and unpad
-                int align_cnt = nrn_soa_padded_size(n, layout);
-                for (int i = 0; i < n; ++i) {
-                    for (int j = 0; j < szdp; ++j) {
-                        mlc->pdata_not_permuted[i * szdp + j] = ml->pdata[i + j * align_cnt];
-                    }
-                }
-            }
-#endif
-        } else {
-            ml->pdata = nullptr;
-        }
-        if (corenrn.get_pnt_map()[type] > 0) {  // POINT_PROCESS mechanism including acell
-            int cnt = ml->nodecount;
-            Point_process* pnt = nullptr;
-            pnt = nt.pntprocs + synoffset;
-            pnt_offset[type] = synoffset;
-            synoffset += cnt;
-            for (int i = 0; i < cnt; ++i) {
-                Point_process* pp = pnt + i;
-                pp->_type = type;
-                pp->_i_instance = i;
-                nt._vdata[ml->pdata[nrn_i_layout(i, cnt, 1, szdp, layout)]] = pp;
-                pp->_tid = nt.id;
-            }
-        }
+    if (native) {
+        set_native_data(nt, pnt_offset);
+    } else {
+        transform_dataset(nt, memb_func, pnt_offset);
     }
 
     // pnt_offset needed for SelfEvent transfer from NEURON. Not needed on GPU.
     // Ugh. Related but not same as NetReceiveBuffer._pnt_offset
     nt._pnt_offset = pnt_offset;
 
-    pdata_relocation(nt, memb_func);
-
-    /* if desired, apply the node permutation. This involves permuting
-       at least the node parameter arrays for a, b, and area (and diam) and all
-       integer vector values that index into nodes. This could have been done
-       when originally filling the arrays with AoS ordered data, but can also
-       be done now, after the SoA transformation. The latter has the advantage
-       that the present order is consistent with all the layout values. Note
-       that after this portion of the permutation, a number of other node index
-       vectors will be read and will need to be permuted as well in subsequent
-       sections of this function.
-    */
-    if (interleave_permute_type) {
-        nt._permute = interleave_order(nt.id, nt.ncell, nt.end, nt._v_parent_index);
-    }
-    if (nt._permute) {
-        int* p = nt._permute;
-        permute_data(nt._actual_a, nt.end, p);
-        permute_data(nt._actual_b, nt.end, p);
-        permute_data(nt._actual_area, nt.end, p);
-        permute_data(nt._actual_v,
-                     nt.end,
-                     p);  // need if restore or finitialize does not initialize voltage
-        if (nt._actual_diam) {
-            permute_data(nt._actual_diam, nt.end, p);
-        }
-        // index values change as well as ordering
-        permute_ptr(nt._v_parent_index, nt.end, p);
-        node_permute(nt._v_parent_index, nt.end, p);
-
-#if CORENRN_DEBUG
-        for (int i = 0; i < nt.end; ++i) {
-            printf("parent[%d] = %d\n", i, nt._v_parent_index[i]);
-        }
-#endif
-
-        // specify the ml->_permute and sort the nodeindices
-        // Have to calculate all the permute before updating pdata in case
-        // POINTER to data of other mechanisms exist.
-        for (auto tml = nt.tml; tml; tml = tml->next) {
-            if (tml->ml->nodeindices) {  // not artificial
-                permute_nodeindices(tml->ml, p);
-            }
-        }
-        for (auto tml = nt.tml; tml; tml = tml->next) {
-            if (tml->ml->nodeindices) {  // not artificial
-                permute_ml(tml->ml, tml->index, nt);
-            }
-        }
-
-        // permute the Point_process._i_instance
-        for (int i = 0; i < nt.n_pntproc; ++i) {
-            Point_process& pp = nt.pntprocs[i];
-            Memb_list* ml = nt._ml_list[pp._type];
-            if (ml->_permute) {
-                pp._i_instance = ml->_permute[pp._i_instance];
-            }
-        }
-    }
-
     set_dependencies(nt, memb_func);
 
     fill_before_after_lists(nt, memb_func);
@@ -1222,7 +1380,7 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
     ntc.output_vindex = new int[nt.n_presyn];
     memcpy(ntc.output_vindex, output_vindex.data(), nt.n_presyn * sizeof(int));
 #endif
-    if (nt._permute) {
+    if (nt._permute && !native) {
         // only indices >= 0 (i.e. _actual_v indices) will be changed.
         node_permute(output_vindex.data(), nt.n_presyn, nt._permute);
     }
@@ -1274,27 +1432,33 @@ void Phase2::populate(NrnThread& nt, const UserParams& userParams) {
 #if CHKPNTDEBUG
     ntc.pnttype = new int[nnetcon];
     ntc.pntindex = new int[nnetcon];
-    memcpy(ntc.pnttype, pnttype.data(), nnetcon * sizeof(int));
-    memcpy(ntc.pntindex, pntindex.data(), nnetcon * sizeof(int));
+    pnttype.copy_to(ntc.pnttype);
+    pntindex.copy_to(ntc.pntindex);
 #endif
-    for (int i = 0; i < nnetcon; ++i) {
-        int type = pnttype[i];
-        if (type > 0) {
-            int index = pnt_offset[type] + pntindex[i];  /// Potentially uninitialized pnt_offset[],
-                                                         /// check for previous assignments
-            NetCon& nc = nt.netcons[i];
-            nc.target_ = nt.pntprocs + index;
-            nc.active_ = true;
+    if (native) {
+        netcon_target.copy_to(nt.netcon_target);
+    } else {
+        for (int i = 0; i < nnetcon; ++i) {
+            int type = pnttype[i];
+            if (type > 0) {
+                /// Potentially uninitialized pnt_offset[], check for previous assignments
+                int index = pnt_offset[type] + pntindex[i];
+                nt.netcon_target[i] = index;
+            }
         }
     }
 
     handle_weights(nt, nnetcon, ntc);
 
+    if (native) {
+        userParams.checkPoints.check_native(nt, native_layout);
+    }
+
     get_info_from_bbcore(nt, memb_func, ntc);
 
     set_vec_play(nt, ntc);
 
-    if (!events.empty()) {
+    if (native || !events.empty()) {
         userParams.checkPoints.restore_tqueue(nt, *this);
     }
 
@@ -25,6 +25,8 @@ class Phase2 {
   public:
     void read_file(FileHandler& F, const NrnThread& nt);
     void read_direct(int thread_id, const NrnThread& nt);
+    /// read a native checkpoint, see CheckPoints::stage_native, instead of the dataset
+    void read_native(FileHandler& F, const NrnThread& nt);
     void populate(NrnThread& nt, const UserParams& userParams);
 
     std::vector<int> preSynConditionEventFlags;
@@ -79,9 +81,17 @@ class Phase2 {
                             int layout,
                             int n_node_);
     void set_net_send_buffer(Memb_list** ml_list, const std::vector<int>& pnt_offset);
+    std::size_t data_size() const;
+    void read_bbcore_arrays(FileHandler& F);
+    void read_vec_play(FileHandler& F);
+    void read_tqueue(FileHandler& F, const NrnThread& nt);
     void restore_events(FileHandler& F);
     void fill_before_after_lists(NrnThread& nt, const std::vector<Memb_func>& memb_func);
     void pdata_relocation(const NrnThread& nt, const std::vector<Memb_func>& memb_func);
+    void transform_dataset(NrnThread& nt,
+                           const std::vector<Memb_func>& memb_func,
+                           std::vector<int>& pnt_offset);
+    void set_native_data(NrnThread& nt, std::vector<int>& pnt_offset);
     void set_dependencies(const NrnThread& nt, const std::vector<Memb_func>& memb_func);
     void handle_weights(NrnThread& nt, int n_netcon, NrnThreadChkpnt& ntc);
     void get_info_from_bbcore(NrnThread& nt,
@@ -108,21 +118,32 @@ class Phase2 {
     std::vector<double> actual_diam;
     */
     double* _data;
+    // arrays that are only copied to their final place can stay in the file mapping
     struct TML {
-        std::vector<int> nodeindices;
-        std::vector<int> pdata;
+        MappedArray<int> nodeindices;
+        MappedArray<int> pdata;
         int type;
         std::vector<int> iArray;
         std::vector<double> dArray;
         std::vector<int> pointer2type;
+        std::vector<int> permute;  // ml->_permute of a native checkpoint
     };
     std::vector<TML> tmls;
     std::vector<int> output_vindex;
     std::vector<double> output_threshold;
-    std::vector<int> pnttype;
-    std::vector<int> pntindex;
-    std::vector<double> weights;
-    std::vector<double> delay;
+    MappedArray<int> pnttype;
+    MappedArray<int> pntindex;
+    MappedArray<double> weights;
+    MappedArray<double> delay;
     int num_point_process;
+
+    // arrays of a native checkpoint are already in their final layout and order
+    bool native = false;
+    std::vector<std::size_t> native_layout;
+    std::vector<int> permute;  // nt._permute
+    MappedArray<int> netcon_target;
+    MappedArray<int> netcon_weight_index;
+    // chkpnt number that the phase 3 file continues from
+    int phase3_chkpnt = 0;
 };
 }  // namespace coreneuron
@@ -0,0 +1,137 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <fstream>
+
+#include "coreneuron/io/phase_prefetch.hpp"
+#include "coreneuron/io/dataset_container.hpp"
+
+namespace coreneuron {
+namespace {
+bool read_whole_file(const std::string& file, std::vector<char>& data) {
+    if (nrn_dataset_container_read(file, data)) {
+        return true;
+    }
+    std::ifstream f(file, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!f.is_open()) {
+        return false;
+    }
+    std::streamsize size = f.tellg();
+    if (size <= 0) {
+        return false;
+    }
+    data.resize(size);
+    f.seekg(0);
+    return static_cast<bool>(f.read(data.data(), size));
+}
+}  // namespace
+
+void PhasePrefetcher::set_window(std::size_t max_files, std::size_t max_bytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        max_files_ = std::max(max_files, std::size_t(1));
+        max_bytes_ = max_bytes;
+    }
+    cv_.notify_all();
+}
+
+bool PhasePrefetcher::window_full() const {
+    return held_files_ >= max_files_ || (held_files_ > 0 && held_bytes_ >= max_bytes_);
+}
+
+void PhasePrefetcher::queue(const std::vector<std::string>& files) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& file: files) {
+            if (entries_.emplace(file, Entry{}).second) {
+                pending_.push_back(file);
+            }
+        }
+        quit_ = false;
+    }
+    if (!thread_.joinable()) {
+        thread_ = std::thread(&PhasePrefetcher::run, this);
+    }
+    cv_.notify_all();
+}
+
+bool PhasePrefetcher::take(const std::string& file, std::vector<char>& data) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = entries_.find(file);
+    if (it == entries_.end()) {
+        return false;
+    }
+    if (!it->second.started) {
+        // the I/O thread is behind or its window is full, read the file here
+        pending_.erase(std::find(pending_.begin(), pending_.end(), file));
+        entries_.erase(it);
+        lock.unlock();
+        return read_whole_file(file, data);
+    }
+    cv_.wait(lock, [&] { return it->second.done; });
+    bool ok = it->second.ok;
+    if (ok) {
+        data = std::move(it->second.data);
+    }
+    --held_files_;
+    held_bytes_ -= it->second.size;
+    entries_.erase(it);
+    lock.unlock();
+    // there is room in the window again
+    cv_.notify_all();
+    return ok;
+}
+
+void PhasePrefetcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+        pending_.clear();
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    entries_.clear();
+    held_files_ = 0;
+    held_bytes_ = 0;
+}
+
+void PhasePrefetcher::run() {
+    for (;;) {
+        std::string file;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return quit_ || (!pending_.empty() && !window_full()); });
+            if (quit_) {
+                return;
+            }
+            file = std::move(pending_.front());
+            pending_.pop_front();
+            entries_[file].started = true;
+            ++held_files_;
+        }
+        // read without holding the lock, the setup threads parse meanwhile
+        std::vector<char> data;
+        bool ok = read_whole_file(file, data);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(file);
+            if (it != entries_.end()) {
+                it->second.ok = ok;
+                it->second.size = data.size();
+                it->second.data = std::move(data);
+                it->second.done = true;
+                held_bytes_ += it->second.size;
+            }
+        }
+        cv_.notify_all();
+    }
+}
+}  // namespace coreneuron
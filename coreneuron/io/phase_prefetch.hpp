@@ -0,0 +1,87 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace coreneuron {
+
+/**
+ * \class PhasePrefetcher
+ * \brief Read data files into memory on a background I/O thread
+ *
+ * With --prefetch-input nrn_setup queues the files of the next phase of all
+ * groups while the current phase is parsed and populated, so that the latency
+ * of opening and reading many small files on a parallel file system overlaps
+ * with the setup work. Files are read in queue order and take() hands the
+ * contents of a file over to the FileHandler that parses it.
+ *
+ * Only a window of files is held in memory: the I/O thread waits while the
+ * files it has read and that were not taken yet reach max_files or max_bytes.
+ * take() reads a file that the I/O thread has not started itself, so a caller
+ * never waits on a full window.
+ */
+class PhasePrefetcher {
+  public:
+    PhasePrefetcher() = default;
+    PhasePrefetcher(const PhasePrefetcher&) = delete;
+    PhasePrefetcher& operator=(const PhasePrefetcher&) = delete;
+    ~PhasePrefetcher() {
+        stop();
+    }
+
+    /// Limit the files read ahead and not taken yet, a single larger file is always read
+    void set_window(std::size_t max_files, std::size_t max_bytes);
+
+    /// Read files in the background, starts the I/O thread on first use
+    void queue(const std::vector<std::string>& files);
+
+    /**
+     * Wait until a queued file has been read and move its contents to data
+     *
+     * @return false if the file was not queued or could not be read, e.g. a
+     *         missing gid_gap.dat, the caller then opens it as usual
+     */
+    bool take(const std::string& file, std::vector<char>& data);
+
+    /// Discard files not taken yet and join the I/O thread
+    void stop();
+
+  private:
+    struct Entry {
+        bool started = false;
+        bool done = false;
+        bool ok = false;
+        std::size_t size = 0;
+        std::vector<char> data;
+    };
+
+    void run();
+    bool window_full() const;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::string> pending_;
+    std::map<std::string, Entry> entries_;
+    std::thread thread_;
+    std::size_t max_files_ = 4;
+    std::size_t max_bytes_ = std::size_t(256) << 20;
+    /// files being read or read and not taken, and their size
+    std::size_t held_files_ = 0;
+    std::size_t held_bytes_ = 0;
+    bool quit_ = false;
+};
+}  // namespace coreneuron
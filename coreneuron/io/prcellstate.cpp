@@ -12,6 +12,7 @@
 #include "coreneuron/nrnconf.h"
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/io/nrn_setup.hpp"
+#include "coreneuron/mechanism/index_compression.hpp"
 #include "coreneuron/network/netcon.hpp"
 #include "coreneuron/nrniv/nrniv_decl.h"
 #include "coreneuron/utils/nrn_assert.h"
@@ -61,7 +62,7 @@ static void pr_memb(int type, Memb_list* ml, int* cellnodes, NrnThread& nt, FILE
     int cnt = ml->nodecount;
     for (int iorig = 0; iorig < ml->nodecount; ++iorig) {  // original index
         int i = ml_permute(iorig, ml);                     // present index
-        int inode = ml->nodeindices[i];                    // inode is the permuted node
+        int inode = nrn_nodeindex(ml, i);                  // inode is the permuted node
         int cix = cellnodes[inv_permute(inode, nt)];       // original index relative to this cell
         if (cix >= 0) {
             if (!header_printed) {
@@ -96,7 +97,7 @@ static void pr_netcon(NrnThread& nt, FILE* f) {
     int nc_cnt = 0;
     for (int i = 0; i < nt.n_netcon; ++i) {
         NetCon* nc = nt.netcons + i;
-        Point_process* pp = nc->target_;
+        Point_process* pp = nc->target();
         std::map<Point_process*, int>::iterator it = pnt2index.find(pp);
         if (it != pnt2index.end()) {
             nclist[it->second].push_back(nc);
@@ -158,36 +159,47 @@ static void pr_netcon(NrnThread& nt, FILE* f) {
                                 "%d %s %d %.*g",
                                 i,
                                 corenrn.get_memb_func(type).sym,
-                                nc->active_ ? 1 : 0,
+                                nc->active() ? 1 : 0,
                                 precision,
-                                nc->delay_);
+                                nc->delay());
                     } else if (srcgid < 0 && ps->thvar_index_ > 0) {
-                        fprintf(
-                            f, "%d %s %d %.*g", i, "v", nc->active_ ? 1 : 0, precision, nc->delay_);
+                        fprintf(f,
+                                "%d %s %d %.*g",
+                                i,
+                                "v",
+                                nc->active() ? 1 : 0,
+                                precision,
+                                nc->delay());
                     } else {
                         fprintf(f,
                                 "%d %d %d %.*g",
                                 i,
                                 srcgid,
-                                nc->active_ ? 1 : 0,
+                                nc->active() ? 1 : 0,
                                 precision,
-                                nc->delay_);
+                                nc->delay());
                     }
                 } else {
                     fprintf(f,
                             "%d %d %d %.*g",
                             i,
                             map_nc2gid[nc],
-                            nc->active_ ? 1 : 0,
+                            nc->active() ? 1 : 0,
                             precision,
-                            nc->delay_);
+                            nc->delay());
                 }
             } else {
-                fprintf(f, "%d %d %d %.*g", i, srcgid, nc->active_ ? 1 : 0, precision, nc->delay_);
+                fprintf(f,
+                        "%d %d %d %.*g",
+                        i,
+                        srcgid,
+                        nc->active() ? 1 : 0,
+                        precision,
+                        nc->delay());
             }
-            int wcnt = corenrn.get_pnt_receive_size()[nc->target_->_type];
+            int wcnt = corenrn.get_pnt_receive_size()[nc->target()->_type];
             for (int k = 0; k < wcnt; ++k) {
-                fprintf(f, " %.*g", precision, nt.weights[nc->u.weight_index_ + k]);
+                fprintf(f, " %.*g", precision, nt.weights[nc->weight_index() + k]);
             }
             fprintf(f, "\n");
         }
@@ -6,10 +6,13 @@
 # =============================================================================
 */
 
+#include <mutex>
+
 #include "report_event.hpp"
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/io/reports/nrnreport.hpp"
 #include "coreneuron/utils/nrn_assert.h"
+#include "coreneuron/utils/nrnmutdec.hpp"
 #ifdef ENABLE_BIN_REPORTS
 #include "reportinglib/Records.h"
 #endif  // ENABLE_BIN_REPORTS
@@ -74,23 +77,23 @@ void ReportEvent::summation_alu(NrnThread* nt) {
 
 /** on deliver, call ReportingLib and setup next event */
 void ReportEvent::deliver(double t, NetCvode* nc, NrnThread* nt) {
-/* reportinglib is not thread safe */
-#pragma omp critical
-    {
-        summation_alu(nt);
-        // each thread needs to know its own step
+    /* reportinglib is not thread safe, a lock rather than omp critical as the
+       thread team members are not OpenMP threads */
+    static OMP_Mutex mut;
+    std::lock_guard<OMP_Mutex> lock(mut);
+    summation_alu(nt);
+    // each thread needs to know its own step
 #ifdef ENABLE_BIN_REPORTS
-        records_nrec(step, gids_to_report.size(), gids_to_report.data(), report_path.data());
+    records_nrec(step, gids_to_report.size(), gids_to_report.data(), report_path.data());
 #endif
 #ifdef ENABLE_SONATA_REPORTS
-        sonata_record_node_data(step,
-                                gids_to_report.size(),
-                                gids_to_report.data(),
-                                report_path.data());
+    sonata_record_node_data(step,
+                            gids_to_report.size(),
+                            gids_to_report.data(),
+                            report_path.data());
 #endif
-        send(t + dt, nc, nt);
-        step++;
-    }
+    send(t + dt, nc, nt);
+    step++;
 }
 
 bool ReportEvent::require_checkpoint() {
@@ -9,6 +9,7 @@
 #include "report_handler.hpp"
 #include "coreneuron/io/nrnsection_mapping.hpp"
 #include "coreneuron/mechanism/mech_mapping.hpp"
+#include "coreneuron/mechanism/index_compression.hpp"
 #include "coreneuron/utils/utils.hpp"
 
 namespace coreneuron {
@@ -238,8 +239,8 @@ VarsToReport ReportHandler::get_summation_vars_to_report(
                 }
 
                 for (int j = 0; j < ml->nodecount; j++) {
-                    auto segment_id = ml->nodeindices[j];
-                    if ((nodes_to_gids[ml->nodeindices[j]] == gid)) {
+                    auto segment_id = nrn_nodeindex(ml, j);
+                    if ((nodes_to_gids[segment_id] == gid)) {
                         double* var_value =
                             get_var_location_from_var_name(mech_id, var_name.data(), ml, j);
                         summation_report.currents_[segment_id].push_back(
@@ -326,7 +327,7 @@ VarsToReport ReportHandler::get_synapse_vars_to_report(
             } else {
                 report_variable = *is_selected != 0.;
             }
-            if ((nodes_to_gids[ml->nodeindices[j]] == gid) && report_variable) {
+            if ((nodes_to_gids[nrn_nodeindex(ml, j)] == gid) && report_variable) {
                 double* var_value = get_var_location_from_var_name(mech_id, var_name.data(), ml, j);
                 double* synapse_id =
                     get_var_location_from_var_name(mech_id, SYNAPSE_ID_MOD_NAME, ml, j);
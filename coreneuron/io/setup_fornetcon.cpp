@@ -114,11 +114,14 @@ void setup_fornetcon_info(NrnThread& nt) {
     // Count how many weight groups for each slot and total number of weight groups
     size_t n_weight_perm = 0;
     for (int i = 0; i < nt.n_netcon; ++i) {
-        NetCon& nc = nt.netcons[i];
-        int mtype = nc.target_->_type;
+        if (nt.netcon_target[i] < 0) {
+            continue;  // no target
+        }
+        Point_process* target = nt.pntprocs + nt.netcon_target[i];
+        int mtype = target->_type;
         auto search = type_to_slot.find(mtype);
         if (search != type_to_slot.end()) {
-            int i_instance = nc.target_->_i_instance;
+            int i_instance = target->_i_instance;
             int* fn = fornetcon_slot(mtype, i_instance, search->second, nt);
             *fn += 1;
             n_weight_perm += 1;
@@ -159,13 +162,16 @@ void setup_fornetcon_info(NrnThread& nt) {
     // nt._fornetcon_weight_perm. To help with this we increment the
     // dparam fornetcon slot on each use.
     for (int i = 0; i < nt.n_netcon; ++i) {
-        NetCon& nc = nt.netcons[i];
-        int mtype = nc.target_->_type;
+        if (nt.netcon_target[i] < 0) {
+            continue;  // no target
+        }
+        Point_process* target = nt.pntprocs + nt.netcon_target[i];
+        int mtype = target->_type;
         auto search = type_to_slot.find(mtype);
         if (search != type_to_slot.end()) {
-            int i_instance = nc.target_->_i_instance;
+            int i_instance = target->_i_instance;
             int* fn = fornetcon_slot(mtype, i_instance, search->second, nt);
-            size_t nc_w_index = size_t(nc.u.weight_index_);
+            size_t nc_w_index = size_t(nt.netcon_weight_index[i]);
             nt._fornetcon_weight_perm[size_t(*fn)] = nc_w_index;
             *fn += 1;  // next item conceptually adjacent
         }
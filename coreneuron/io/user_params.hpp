@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "coreneuron/io/phase_prefetch.hpp"
+
 namespace coreneuron {
 
 class CheckPoints;
@@ -38,6 +40,8 @@ struct UserParams {
     /// Dataset path from where simulation is being restored
     const char* const restore_path;
     std::vector<FileHandler> file_reader;
+    /// Background reader of the phase files (--prefetch-input)
+    PhasePrefetcher prefetcher;
     CheckPoints& checkPoints;
 };
 }  // namespace coreneuron
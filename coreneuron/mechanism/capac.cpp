@@ -55,7 +55,10 @@ for pure implicit fixed step it is 1/dt
 It used to be static but is now a thread data variable
 */
 
-void nrn_jacob_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
+/* the kernels that use nodeindices are templates on the index type, int or
+   uint16_t with --index-compression, see index_compression.hpp */
+template <typename Index>
+static void jacob_capacitance(NrnThread* _nt, Memb_list* ml, const Index* ni) {
     int _cntml_actual = ml->nodecount;
     int _cntml_padded = ml->_nodecount_padded;
     int _iml;
@@ -66,8 +69,6 @@ void nrn_jacob_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
     double* _vec_d = _nt->_actual_d;
 
     { /*if (use_cachevec) {*/
-        int* ni = ml->nodeindices;
-
         vdata = ml->data;
         nrn_pragma_acc(parallel loop present(vdata [0:_cntml_padded * nparm],
                                              ni [0:_cntml_actual],
@@ -80,6 +81,14 @@ void nrn_jacob_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
     }
 }
 
+void nrn_jacob_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
+    if (ml->nodeindices16) {
+        jacob_capacitance(_nt, ml, ml->nodeindices16);
+    } else {
+        jacob_capacitance(_nt, ml, ml->nodeindices);
+    }
+}
+
 void nrn_init_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
     int _cntml_actual = ml->nodecount;
     int _cntml_padded = ml->_nodecount_padded;
@@ -98,7 +107,8 @@ void nrn_init_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
     }
 }
 
-void nrn_cur_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
+template <typename Index>
+static void cur_capacitance(NrnThread* _nt, Memb_list* ml, const Index* ni) {
     int _cntml_actual = ml->nodecount;
     int _cntml_padded = ml->_nodecount_padded;
     double* vdata;
@@ -111,7 +121,6 @@ void nrn_cur_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
     /* since rhs is dvm for a full or half implicit step */
     /* (nrn_update_2d() replaces dvi by dvi-dvx) */
     /* no need to distinguish secondorder */
-    int* ni = ml->nodeindices;
     double* _vec_rhs = _nt->_actual_rhs;
 
     vdata = ml->data;
@@ -125,6 +134,14 @@ void nrn_cur_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
     }
 }
 
+void nrn_cur_capacitance(NrnThread* _nt, Memb_list* ml, int /* type */) {
+    if (ml->nodeindices16) {
+        cur_capacitance(_nt, ml, ml->nodeindices16);
+    } else {
+        cur_capacitance(_nt, ml, ml->nodeindices);
+    }
+}
+
 /* the rest can be constructed automatically from the above info*/
 
 void nrn_alloc_capacitance(double* data, Datum* pdata, int type) {
@@ -133,18 +150,15 @@ void nrn_alloc_capacitance(double* data, Datum* pdata, int type) {
     data[0] = DEF_cm; /*default capacitance/cm^2*/
 }
 
-void nrn_div_capacity(NrnThread* _nt, Memb_list* ml, int type) {
-    (void) type;
+template <typename Index>
+static void div_capacity(NrnThread* _nt, Memb_list* ml, const Index* ni) {
     int _cntml_actual = ml->nodecount;
     int _cntml_padded = ml->_nodecount_padded;
     int _iml;
     double* vdata;
     (void) _nt;
-    (void) type;
     (void) _cntml_padded; /* unused */
 
-    int* ni = ml->nodeindices;
-
     vdata = ml->data;
     _PRAGMA_FOR_INIT_ACC_LOOP_
     for (_iml = 0; _iml < _cntml_actual; _iml++) {
@@ -154,18 +168,24 @@ void nrn_div_capacity(NrnThread* _nt, Memb_list* ml, int type) {
     }
 }
 
-void nrn_mul_capacity(NrnThread* _nt, Memb_list* ml, int type) {
+void nrn_div_capacity(NrnThread* _nt, Memb_list* ml, int type) {
     (void) type;
+    if (ml->nodeindices16) {
+        div_capacity(_nt, ml, ml->nodeindices16);
+    } else {
+        div_capacity(_nt, ml, ml->nodeindices);
+    }
+}
+
+template <typename Index>
+static void mul_capacity(NrnThread* _nt, Memb_list* ml, const Index* ni) {
     int _cntml_actual = ml->nodecount;
     int _cntml_padded = ml->_nodecount_padded;
     int _iml;
     double* vdata;
     (void) _nt;
-    (void) type;
     (void) _cntml_padded; /* unused */
 
-    int* ni = ml->nodeindices;
-
     const double cfac = .001 * _nt->cj;
 
     vdata = ml->data;
@@ -174,4 +194,13 @@ void nrn_mul_capacity(NrnThread* _nt, Memb_list* ml, int type) {
         VEC_RHS(ni[_iml]) *= cfac * cm;
     }
 }
+
+void nrn_mul_capacity(NrnThread* _nt, Memb_list* ml, int type) {
+    (void) type;
+    if (ml->nodeindices16) {
+        mul_capacity(_nt, ml, ml->nodeindices16);
+    } else {
+        mul_capacity(_nt, ml, ml->nodeindices);
+    }
+}
 }  // namespace coreneuron
@@ -198,16 +198,16 @@ double nrn_nernst_coef(int type) {
     return ktf(celsius) / charge;
 }
 
-/* Must be called prior to any channels which update the currents */
-void nrn_cur_ion(NrnThread* nt, Memb_list* ml, int type) {
+/* the kernels are templates on the pdata and nodeindices type, int or uint16_t
+   with --index-compression, see index_compression.hpp */
+template <typename Index>
+static void cur_ion(NrnThread* nt, Memb_list* ml, int type, const Index* ppd) {
     int _cntml_actual = ml->nodecount;
     double* pd;
-    Datum* ppd;
     (void) nt; /* unused */
     /*printf("ion_cur %s\n", memb_func[type].sym->name);*/
     int _cntml_padded = ml->_nodecount_padded;
     pd = ml->data;
-    ppd = ml->pdata;
     // clang-format off
     nrn_pragma_acc(parallel loop present(pd[0:_cntml_padded * 5],
                                          ppd[0:_cntml_actual],
@@ -226,13 +226,19 @@ void nrn_cur_ion(NrnThread* nt, Memb_list* ml, int type) {
     };
 }
 
-/* Must be called prior to other models which possibly also initialize
-        concentrations based on their own states
-*/
-void nrn_init_ion(NrnThread* nt, Memb_list* ml, int type) {
+/* Must be called prior to any channels which update the currents */
+void nrn_cur_ion(NrnThread* nt, Memb_list* ml, int type) {
+    if (ml->pdata16) {
+        cur_ion(nt, ml, type, ml->pdata16);
+    } else {
+        cur_ion(nt, ml, type, ml->pdata);
+    }
+}
+
+template <typename Index>
+static void init_ion(NrnThread* nt, Memb_list* ml, int type, const Index* ppd) {
     int _cntml_actual = ml->nodecount;
     double* pd;
-    Datum* ppd;
     (void) nt; /* unused */
 
     // skip initialization if restoring from checkpoint
@@ -243,7 +249,6 @@ void nrn_init_ion(NrnThread* nt, Memb_list* ml, int type) {
     /*printf("ion_init %s\n", memb_func[type].sym->name);*/
     int _cntml_padded = ml->_nodecount_padded;
     pd = ml->data;
-    ppd = ml->pdata;
     // There was no async(...) clause in the initial OpenACC implementation, so
     // no `nowait` clause has been added to the OpenMP implementation. TODO:
     // verify if this can be made asynchronous or if there is a strong reason it
@@ -267,31 +272,46 @@ void nrn_init_ion(NrnThread* nt, Memb_list* ml, int type) {
     }
 }
 
+/* Must be called prior to other models which possibly also initialize
+        concentrations based on their own states
+*/
+void nrn_init_ion(NrnThread* nt, Memb_list* ml, int type) {
+    if (ml->pdata16) {
+        init_ion(nt, ml, type, ml->pdata16);
+    } else {
+        init_ion(nt, ml, type, ml->pdata);
+    }
+}
+
 void nrn_alloc_ion(double* p, Datum* ppvar, int _type) {
     assert(0);
 }
 
-void second_order_cur(NrnThread* _nt, int secondorder) {
-    int _cntml_padded;
-    double* pd;
-    (void) _nt; /* unused */
+template <typename Index>
+static void second_order_cur_ion(NrnThread* _nt, Memb_list* ml, const Index* ni) {
     double* _vec_rhs = _nt->_actual_rhs;
+    int _cntml_actual = ml->nodecount;
+    int _cntml_padded = ml->_nodecount_padded;
+    double* pd = ml->data;
+    nrn_pragma_acc(parallel loop present(pd [0:_cntml_padded * 5],
+                                         ni [0:_cntml_actual],
+                                         _vec_rhs [0:_nt->end]) if (_nt->compute_gpu)
+                       async(_nt->stream_id))
+    nrn_pragma_omp(target teams distribute parallel for simd if(_nt->compute_gpu))
+    for (int _iml = 0; _iml < _cntml_actual; ++_iml) {
+        cur += dcurdv * (_vec_rhs[ni[_iml]]);
+    }
+}
 
+void second_order_cur(NrnThread* _nt, int secondorder) {
     if (secondorder == 2) {
         for (NrnThreadMembList* tml = _nt->tml; tml; tml = tml->next)
             if (nrn_is_ion(tml->index)) {
                 Memb_list* ml = tml->ml;
-                int _cntml_actual = ml->nodecount;
-                int* ni = ml->nodeindices;
-                _cntml_padded = ml->_nodecount_padded;
-                pd = ml->data;
-                nrn_pragma_acc(parallel loop present(pd [0:_cntml_padded * 5],
-                                                     ni [0:_cntml_actual],
-                                                     _vec_rhs [0:_nt->end]) if (_nt->compute_gpu)
-                                   async(_nt->stream_id))
-                nrn_pragma_omp(target teams distribute parallel for simd if(_nt->compute_gpu))
-                for (int _iml = 0; _iml < _cntml_actual; ++_iml) {
-                    cur += dcurdv * (_vec_rhs[ni[_iml]]);
+                if (ml->nodeindices16) {
+                    second_order_cur_ion(_nt, ml, ml->nodeindices16);
+                } else {
+                    second_order_cur_ion(_nt, ml, ml->nodeindices);
                 }
             }
     }
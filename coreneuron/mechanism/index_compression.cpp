@@ -0,0 +1,141 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+
+#include "coreneuron/mechanism/index_compression.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/coreneuron.hpp"
+#include "coreneuron/mechanism/eion.hpp"
+#include "coreneuron/mechanism/membfunc.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/utils/memory.h"
+
+namespace coreneuron {
+
+namespace {
+// 16 bit copy of the n values of index, nullptr if one is not in [lo, 65535] or none.
+// lo = -1 maps -1 to UINT16_MAX, which must then not be a value
+std::uint16_t* narrow(const int* index, std::size_t n, int lo = 0) {
+    if (!index || n == 0) {
+        return nullptr;
+    }
+    int hi = std::numeric_limits<std::uint16_t>::max() - (lo < 0 ? 1 : 0);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (index[i] < lo || index[i] > hi) {
+            return nullptr;
+        }
+    }
+    auto p = static_cast<std::uint16_t*>(emalloc_align(n * sizeof(std::uint16_t)));
+    for (std::size_t i = 0; i < n; ++i) {
+        p[i] = static_cast<std::uint16_t>(index[i]);
+    }
+    return p;
+}
+
+// replace index by its 16 bit version, if there is one
+void replace(int*& index, std::uint16_t*& index16, std::uint16_t* narrowed) {
+    if (!narrowed) {
+        return;
+    }
+    free_memory(index16);
+    index16 = narrowed;
+    free_memory(index);
+    index = nullptr;
+}
+}  // namespace
+
+void nrn_compress_indices(Memb_list* ml, int type) {
+    replace(ml->nodeindices, ml->nodeindices16, narrow(ml->nodeindices, ml->nodecount));
+    if (nrn_is_ion(type)) {
+        // one iontype per instance, see eion.cpp
+        std::size_t n = std::size_t(ml->_nodecount_padded) *
+                        corenrn.get_prop_dparam_size()[type];
+        replace(ml->pdata, ml->pdata16, narrow(ml->pdata, n));
+    }
+}
+
+void nrn_compress_indices(NrnThread* nt) {
+    if (!corenrn_param.index_compression || corenrn_param.gpu) {
+        return;
+    }
+    for (auto tml = nt->tml; tml; tml = tml->next) {
+        if (tml->index == CAP || nrn_is_ion(tml->index)) {
+            nrn_compress_indices(tml->ml, tml->index);
+        }
+    }
+    replace(nt->netcon_target,
+            nt->netcon_target16,
+            narrow(nt->netcon_target, nt->n_netcon, -1));
+    replace(nt->netcon_weight_index,
+            nt->netcon_weight_index16,
+            narrow(nt->netcon_weight_index, nt->n_netcon));
+}
+
+void nrn_free_compressed_indices(Memb_list* ml) {
+    free_memory(ml->nodeindices16);
+    ml->nodeindices16 = nullptr;
+    free_memory(ml->pdata16);
+    ml->pdata16 = nullptr;
+}
+
+void nrn_free_compressed_indices(NrnThread* nt) {
+    free_memory(nt->netcon_target16);
+    nt->netcon_target16 = nullptr;
+    free_memory(nt->netcon_weight_index16);
+    nt->netcon_weight_index16 = nullptr;
+}
+
+int* nrn_pdata_int(const Memb_list* ml, std::size_t n, std::vector<int>& buffer) {
+    if (!ml->pdata16) {
+        return ml->pdata;
+    }
+    buffer.assign(ml->pdata16, ml->pdata16 + n);
+    return buffer.data();
+}
+
+void nrn_index_compression_report() {
+    if (!corenrn_param.index_compression) {
+        return;
+    }
+    // node indices and NetCon indices, total and 16 bit
+    double v[4] = {0., 0., 0., 0.};
+    for (int i = 0; i < nrn_nthread; ++i) {
+        const NrnThread& nt = nrn_threads[i];
+        for (auto tml = nt.tml; tml; tml = tml->next) {
+            if (tml->index == CAP || nrn_is_ion(tml->index)) {
+                v[0] += tml->ml->nodecount;
+                v[1] += tml->ml->nodeindices16 ? tml->ml->nodecount : 0;
+            }
+        }
+        v[2] += 2 * nt.n_netcon;
+        v[3] += (nt.netcon_target16 ? nt.n_netcon : 0) +
+                (nt.netcon_weight_index16 ? nt.n_netcon : 0);
+    }
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        double all[4];
+        nrnmpi_dbl_allreduce_vec(v, all, 4, 1);
+        std::copy(all, all + 4, v);
+    }
+#endif
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" 16 bit indices: %.0f of %.0f capacitance and ion node indices, %.0f of %.0f "
+               "NetCon indices, %.1f MB saved\n",
+               v[1],
+               v[0],
+               v[3],
+               v[2],
+               2. * (v[1] + v[3]) / (1024. * 1024.));
+    }
+}
+}  // namespace coreneuron
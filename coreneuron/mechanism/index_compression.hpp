@@ -0,0 +1,54 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "coreneuron/mechanism/mechanism.hpp"
+
+namespace coreneuron {
+struct NrnThread;
+
+/**
+ * \brief 16 bit index arrays (--index-compression)
+ *
+ * After setup, every index array below whose values all fit in 16 bits is
+ * replaced by a uint16_t array and the int array is freed:
+ *  - Memb_list::nodeindices of the capacitance and ion mechanisms, and the
+ *    pdata (iontype) of the ions, by nodeindices16 and pdata16. Their kernels
+ *    run over every compartment in every step and are templates on the index
+ *    type.
+ *  - NrnThread::netcon_target and netcon_weight_index, the per synapse
+ *    indices of the NetCons, by netcon_target16 (UINT16_MAX for no target) and
+ *    netcon_weight_index16. They are read through nrn_netcon_target and
+ *    nrn_netcon_weight_index.
+ * The nodeindices and pdata of the mechanisms translated from MOD files, the
+ * point processes among them, stay int as the generated kernels index them
+ * directly. Not used with GPU execution.
+ */
+
+/// Compress the index arrays of nt, if --index-compression
+void nrn_compress_indices(NrnThread* nt);
+/// Compress nodeindices, and for ions pdata, of the Memb_list of type
+void nrn_compress_indices(Memb_list* ml, int type);
+void nrn_free_compressed_indices(Memb_list* ml);
+void nrn_free_compressed_indices(NrnThread* nt);
+
+/// Node index i of ml, whether compressed or not
+inline int nrn_nodeindex(const Memb_list* ml, int i) {
+    return ml->nodeindices16 ? ml->nodeindices16[i] : ml->nodeindices[i];
+}
+
+/// The first n pdata of ml, widened into buffer if they are compressed
+int* nrn_pdata_int(const Memb_list* ml, std::size_t n, std::vector<int>& buffer);
+
+/// Print on rank 0 how many indices are 16 bit
+void nrn_index_compression_report();
+}  // namespace coreneuron
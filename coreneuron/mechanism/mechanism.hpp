@@ -8,6 +8,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string.h>
 
 #include "coreneuron/nrnconf.h"
@@ -123,7 +124,7 @@ struct NetSendBuffer_t: MemoryManaged {
         T* new_buf = nullptr;
         new_buf = (T*) ecalloc_align(new_size, sizeof(T));
         memcpy(new_buf, *buf, size * sizeof(T));
-        free(*buf);
+        free_memory(*buf);
         *buf = new_buf;
     }
 };
@@ -135,6 +136,9 @@ struct Memb_list {
      * order of insertion and via the node-structure, making it more
      * cache-efficient */
     int* nodeindices = nullptr;
+    /* replace nodeindices and pdata when they fit, see index_compression.hpp */
+    std::uint16_t* nodeindices16 = nullptr;
+    std::uint16_t* pdata16 = nullptr;
     int* _permute = nullptr;
     double* data = nullptr;
     Datum* pdata = nullptr;
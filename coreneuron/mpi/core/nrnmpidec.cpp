@@ -20,11 +20,29 @@ mpi_function<cnrn_make_integral_constant_t(nrnmpi_check_threading_support_impl)>
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_write_file_impl)> nrnmpi_write_file{
     "nrnmpi_write_file_impl"};
 
+/* from mpishm.cpp */
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_shm_spike_init_impl)> nrnmpi_shm_spike_init{
+    "nrnmpi_shm_spike_init_impl"};
+
 /* from mpispike.c */
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_impl)> nrnmpi_spike_exchange{
     "nrnmpi_spike_exchange_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_compressed_impl)>
     nrnmpi_spike_exchange_compressed{"nrnmpi_spike_exchange_compressed_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_varint_impl)>
+    nrnmpi_spike_exchange_varint{"nrnmpi_spike_exchange_varint_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_neighbor_comm_create_impl)>
+    nrnmpi_neighbor_comm_create{"nrnmpi_neighbor_comm_create_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_neighbor_comm_free_impl)>
+    nrnmpi_neighbor_comm_free{"nrnmpi_neighbor_comm_free_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_neighbor_impl)>
+    nrnmpi_spike_exchange_neighbor{"nrnmpi_spike_exchange_neighbor_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_hierarchical_init_impl)>
+    nrnmpi_spike_exchange_hierarchical_init{"nrnmpi_spike_exchange_hierarchical_init_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_hierarchical_enable_impl)>
+    nrnmpi_spike_exchange_hierarchical_enable{"nrnmpi_spike_exchange_hierarchical_enable_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_inplace_impl)>
+    nrnmpi_spike_exchange_inplace{"nrnmpi_spike_exchange_inplace_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_int_allmax_impl)> nrnmpi_int_allmax{
     "nrnmpi_int_allmax_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_int_allgather_impl)> nrnmpi_int_allgather{
@@ -35,6 +53,18 @@ mpi_function<cnrn_make_integral_constant_t(nrnmpi_int_alltoallv_impl)> nrnmpi_in
     "nrnmpi_int_alltoallv_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_alltoallv_impl)> nrnmpi_dbl_alltoallv{
     "nrnmpi_dbl_alltoallv_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_ialltoallv_impl)> nrnmpi_dbl_ialltoallv{
+    "nrnmpi_dbl_ialltoallv_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_ialltoallv_wait_impl)>
+    nrnmpi_dbl_ialltoallv_wait{"nrnmpi_dbl_ialltoallv_wait_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_gap_neighbor_init_impl)>
+    nrnmpi_gap_neighbor_init{"nrnmpi_gap_neighbor_init_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_gap_neighbor_free_impl)>
+    nrnmpi_gap_neighbor_free{"nrnmpi_gap_neighbor_free_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_gap_neighbor_start_impl)>
+    nrnmpi_gap_neighbor_start{"nrnmpi_gap_neighbor_start_impl"};
+mpi_function<cnrn_make_integral_constant_t(nrnmpi_gap_neighbor_wait_impl)>
+    nrnmpi_gap_neighbor_wait{"nrnmpi_gap_neighbor_wait_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_allmin_impl)> nrnmpi_dbl_allmin{
     "nrnmpi_dbl_allmin_impl"};
 mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_allmax_impl)> nrnmpi_dbl_allmax{
@@ -0,0 +1,212 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+
+#include "coreneuron/nrnconf.h"
+#include "coreneuron/mpi/nrnmpiuse.h"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/mpi/nrnmpidec.h"
+#include "nrnmpi.hpp"
+#include "coreneuron/utils/nrn_assert.h"
+
+#include <mpi.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace coreneuron {
+extern MPI_Comm nrnmpi_comm;
+
+/*
+Shared memory spike exchange for runs in which all ranks are on the same node.
+A POSIX shared memory segment holds a barrier followed, for each of two
+alternating phases, by one slot per rank. A slot is the number of spikes
+followed by room for shm_capacity_ spikes. During an exchange a rank copies
+its spikes into its own slot of the current phase, waits at the barrier and
+then copies the slots of all ranks. Since the phases alternate, a slot is only
+rewritten after every rank has passed the next barrier, i.e. after everybody
+has read it, so one barrier per exchange is enough.
+If any rank has more spikes than fit in a slot, all ranks see it after the
+barrier and the exchange falls back to MPI_Allgatherv.
+*/
+
+static_assert(std::atomic<int>::is_always_lock_free,
+              "shared memory spike exchange requires lock free atomics");
+
+// sense reversing barrier shared by the processes
+struct ShmBarrier {
+    std::atomic<int> count{0};
+    std::atomic<int> sense{0};
+};
+
+static constexpr std::size_t shm_align = 64;
+static char* shm_base_{nullptr};
+static std::size_t shm_size_;
+static std::size_t shm_slot_size_;
+static int shm_capacity_;
+static int shm_phase_;
+static int shm_local_sense_;
+
+static std::size_t shm_round_up(std::size_t n) {
+    return (n + shm_align - 1) / shm_align * shm_align;
+}
+
+static int* shm_slot(int phase, int rank) {
+    std::size_t offset = shm_round_up(sizeof(ShmBarrier)) +
+                         (phase * nrnmpi_numprocs_ + rank) * shm_slot_size_;
+    return reinterpret_cast<int*>(shm_base_ + offset);
+}
+
+// spikes of a slot start after the spike count, at the alignment of NRNMPI_Spike
+static NRNMPI_Spike* shm_slot_spikes(int* slot) {
+    return reinterpret_cast<NRNMPI_Spike*>(reinterpret_cast<char*>(slot) + sizeof(NRNMPI_Spike));
+}
+
+static void shm_barrier() {
+    auto* barrier = reinterpret_cast<ShmBarrier*>(shm_base_);
+    shm_local_sense_ = 1 - shm_local_sense_;
+    if (barrier->count.fetch_add(1) == nrnmpi_numprocs_ - 1) {
+        barrier->count.store(0);
+        barrier->sense.store(shm_local_sense_);
+    } else {
+        while (barrier->sense.load() != shm_local_sense_) {
+            sched_yield();
+        }
+    }
+}
+
+/**
+ * Create the shared memory segment used for the spike exchange
+ *
+ * Collective over nrnmpi_comm. The shared memory exchange is only possible
+ * when all ranks run on the same node. The segment is unlinked as soon as
+ * every rank has mapped it, so that it does not outlive the processes.
+ *
+ * @param capacity number of spikes a rank can send per exchange without falling
+ *                 back to MPI_Allgatherv
+ * @return true if the shared memory exchange is used, false otherwise
+ */
+bool nrnmpi_shm_spike_init_impl(int capacity) {
+    if (shm_base_ || capacity <= 0 || nrnmpi_local_size_impl() != nrnmpi_numprocs_) {
+        return shm_base_ != nullptr;
+    }
+    shm_capacity_ = capacity;
+    shm_slot_size_ = shm_round_up((capacity + 1) * sizeof(NRNMPI_Spike));
+    shm_size_ = shm_round_up(sizeof(ShmBarrier)) + 2 * nrnmpi_numprocs_ * shm_slot_size_;
+
+    long id = getpid();
+    MPI_Bcast(&id, 1, MPI_LONG, 0, nrnmpi_comm);
+    std::string name = "/corenrn_spikes_" + std::to_string(id);
+
+    int fd = -1;
+    int ok = 1;
+    if (nrnmpi_myid_ == 0) {
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        ok = (fd >= 0 && ftruncate(fd, shm_size_) == 0);
+    }
+    MPI_Bcast(&ok, 1, MPI_INT, 0, nrnmpi_comm);
+    if (ok && nrnmpi_myid_ != 0) {
+        fd = shm_open(name.c_str(), O_RDWR, 0600);
+        ok = (fd >= 0);
+    }
+    void* base = MAP_FAILED;
+    if (ok) {
+        base = mmap(nullptr, shm_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ok = (base != MAP_FAILED);
+    }
+    // the creator constructs the barrier, the others use it only after the MPI_Allreduce below
+    if (ok && nrnmpi_myid_ == 0) {
+        new (base) ShmBarrier{};
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    int all_ok;
+    MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, nrnmpi_comm);
+    if (nrnmpi_myid_ == 0) {
+        shm_unlink(name.c_str());
+    }
+    if (!all_ok) {
+        if (base != MAP_FAILED) {
+            munmap(base, shm_size_);
+        }
+        return false;
+    }
+    shm_base_ = static_cast<char*>(base);
+    shm_phase_ = 0;
+    shm_local_sense_ = 0;
+    return true;
+}
+
+void nrnmpi_shm_spike_finalize() {
+    if (shm_base_) {
+        munmap(shm_base_, shm_size_);
+        shm_base_ = nullptr;
+    }
+}
+
+/**
+ * Gather the spikes of all ranks through the shared memory segment
+ *
+ * Same semantics as the MPI_Allgatherv branch of nrnmpi_spike_exchange_impl.
+ *
+ * @return number of spikes received, or -1 if the shared memory exchange is not
+ *         active or some rank has more spikes than fit in its slot
+ */
+int nrnmpi_shm_spike_exchange(int* nin,
+                              NRNMPI_Spike* spikeout,
+                              int nout,
+                              int& icapacity,
+                              NRNMPI_Spike** spikein) {
+    if (!shm_base_) {
+        return -1;
+    }
+    int* slot = shm_slot(shm_phase_, nrnmpi_myid_);
+    *slot = nout;
+    if (nout <= shm_capacity_) {
+        std::memcpy(shm_slot_spikes(slot), spikeout, nout * sizeof(NRNMPI_Spike));
+    }
+    shm_barrier();
+
+    int n = 0;
+    bool overflow = false;
+    for (int i = 0; i < nrnmpi_numprocs_; ++i) {
+        nin[i] = *shm_slot(shm_phase_, i);
+        overflow = overflow || nin[i] > shm_capacity_;
+        n += nin[i];
+    }
+    if (overflow) {
+        shm_phase_ = 1 - shm_phase_;
+        return -1;
+    }
+    if (n) {
+        if (icapacity < n) {
+            icapacity = n + 10;
+            free(*spikein);
+            *spikein = static_cast<NRNMPI_Spike*>(malloc(icapacity * sizeof(NRNMPI_Spike)));
+            nrn_assert(*spikein);
+        }
+        NRNMPI_Spike* dest = *spikein;
+        for (int i = 0; i < nrnmpi_numprocs_; ++i) {
+            std::memcpy(dest,
+                        shm_slot_spikes(shm_slot(shm_phase_, i)),
+                        nin[i] * sizeof(NRNMPI_Spike));
+            dest += nin[i];
+        }
+    }
+    shm_phase_ = 1 - shm_phase_;
+    return n;
+}
+}  // namespace coreneuron
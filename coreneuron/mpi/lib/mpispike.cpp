@@ -18,6 +18,7 @@
 #include <mpi.h>
 
 #include <cstring>
+#include <vector>
 
 namespace coreneuron {
 extern MPI_Comm nrnmpi_comm;
@@ -79,6 +80,178 @@ void wait_before_spike_exchange() {
     MPI_Barrier(nrnmpi_comm);
 }
 
+/*
+Two level spike exchange. The spikes of the ranks of a shared memory node are
+gathered on a node leader, only the leaders take part in the inter-node
+MPI_Allgatherv, which receives directly into a shared memory window of the
+node. The other ranks of the node read the spikes in place, see
+nrnmpi_spike_exchange_inplace_impl. The number of inter-node messages is
+reduced by the number of ranks per node. The order of the received spikes is
+by node rather than by rank, and nin is not filled, which does not matter for
+the delivery.
+*/
+static MPI_Comm node_comm{MPI_COMM_NULL};
+static MPI_Comm leader_comm{MPI_COMM_NULL};
+static bool hierarchical_enabled;
+static int node_rank;
+static int node_size;
+static int* node_nin{nullptr};
+static int* node_displs{nullptr};
+static int* leader_nin{nullptr};
+static int* leader_displs{nullptr};
+static NRNMPI_Spike* node_spikes{nullptr};
+static int node_spikes_capacity;
+static MPI_Win node_win{MPI_WIN_NULL};
+static NRNMPI_Spike* node_win_spikes{nullptr};
+static int node_win_capacity;
+// the spikes of the last exchange are in node_win_spikes
+static bool node_win_received;
+
+// (re)allocate the shared window, collective over node_comm
+static void node_window_allocate(int capacity) {
+    if (node_win != MPI_WIN_NULL) {
+        MPI_Win_unlock_all(node_win);
+        MPI_Win_free(&node_win);
+    }
+    node_win_capacity = capacity;
+    MPI_Aint size = (node_rank == 0) ? capacity * sizeof(NRNMPI_Spike) : 0;
+    void* base;
+    MPI_Win_allocate_shared(
+        size, sizeof(NRNMPI_Spike), MPI_INFO_NULL, node_comm, &base, &node_win);
+    int disp_unit;
+    MPI_Win_shared_query(node_win, 0, &size, &disp_unit, &base);
+    node_win_spikes = static_cast<NRNMPI_Spike*>(base);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, node_win);
+}
+
+/**
+ * Set up the communicators of the two level spike exchange
+ *
+ * Collective over nrnmpi_comm.
+ *
+ * @return number of nodes
+ */
+int nrnmpi_spike_exchange_hierarchical_init_impl() {
+    if (node_comm == MPI_COMM_NULL) {
+        MPI_Comm_split_type(
+            nrnmpi_comm, MPI_COMM_TYPE_SHARED, nrnmpi_myid_, MPI_INFO_NULL, &node_comm);
+        MPI_Comm_rank(node_comm, &node_rank);
+        MPI_Comm_size(node_comm, &node_size);
+        MPI_Comm_split(
+            nrnmpi_comm, node_rank == 0 ? 0 : MPI_UNDEFINED, nrnmpi_myid_, &leader_comm);
+        node_nin = (int*) emalloc(node_size * sizeof(int));
+        node_displs = (int*) emalloc(node_size * sizeof(int));
+        node_window_allocate(100);
+    }
+    hierarchical_enabled = true;
+    int nnode = node_rank == 0;
+    MPI_Allreduce(MPI_IN_PLACE, &nnode, 1, MPI_INT, MPI_SUM, nrnmpi_comm);
+    return nnode;
+}
+
+/// Switch between the two level and the flat exchange once the former is set up
+void nrnmpi_spike_exchange_hierarchical_enable_impl(bool enable) {
+    hierarchical_enabled = enable && node_comm != MPI_COMM_NULL;
+}
+
+/**
+ * Spikes received by the last nrnmpi_spike_exchange_impl, if they were left in
+ * the shared window of the node instead of spikein
+ *
+ * The window is valid until the next exchange.
+ */
+const NRNMPI_Spike* nrnmpi_spike_exchange_inplace_impl() {
+    return node_win_received ? node_win_spikes : nullptr;
+}
+
+void nrnmpi_spike_exchange_hierarchical_finalize() {
+    if (node_win != MPI_WIN_NULL) {
+        MPI_Win_unlock_all(node_win);
+        MPI_Win_free(&node_win);
+    }
+    node_win_spikes = nullptr;
+    node_win_capacity = 0;
+    node_win_received = false;
+    hierarchical_enabled = false;
+    free(node_nin);
+    free(node_displs);
+    free(leader_nin);
+    free(leader_displs);
+    free(node_spikes);
+    node_nin = node_displs = leader_nin = leader_displs = nullptr;
+    node_spikes = nullptr;
+    node_spikes_capacity = 0;
+    if (leader_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&leader_comm);
+    }
+    if (node_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&node_comm);
+    }
+}
+
+// The received spikes are left in node_win_spikes.
+static int hierarchical_spike_exchange(NRNMPI_Spike* spikeout, int nout) {
+    // gather the spikes of the node on the leader
+    MPI_Gather(&nout, 1, MPI_INT, node_nin, 1, MPI_INT, 0, node_comm);
+    int n = 0;
+    if (node_rank == 0) {
+        for (int i = 0; i < node_size; ++i) {
+            node_displs[i] = n;
+            n += node_nin[i];
+        }
+        if (node_spikes_capacity < n + 1) {
+            node_spikes_capacity = n + 10;
+            free(node_spikes);
+            node_spikes = (NRNMPI_Spike*) emalloc(node_spikes_capacity * sizeof(NRNMPI_Spike));
+        }
+    }
+    MPI_Gatherv(
+        spikeout, nout, spike_type, node_spikes, node_nin, node_displs, spike_type, 0, node_comm);
+
+    // total number of spikes, known to the leaders only
+    int nnode = n;
+    int nleader = 0;
+    if (node_rank == 0) {
+        MPI_Comm_size(leader_comm, &nleader);
+        if (!leader_nin) {
+            leader_nin = (int*) emalloc(nleader * sizeof(int));
+            leader_displs = (int*) emalloc(nleader * sizeof(int));
+        }
+        MPI_Allgather(&nnode, 1, MPI_INT, leader_nin, 1, MPI_INT, leader_comm);
+        n = 0;
+        for (int i = 0; i < nleader; ++i) {
+            leader_displs[i] = n;
+            n += leader_nin[i];
+        }
+    }
+    MPI_Bcast(&n, 1, MPI_INT, 0, node_comm);
+    if (n == 0) {
+        return 0;
+    }
+    if (node_win_capacity < n) {
+        node_window_allocate(n + 10);
+    }
+
+    // exchange between the node leaders, directly into the shared window
+    if (node_rank == 0) {
+        MPI_Allgatherv(node_spikes,
+                       nnode,
+                       spike_type,
+                       node_win_spikes,
+                       leader_nin,
+                       leader_displs,
+                       spike_type,
+                       leader_comm);
+    }
+    MPI_Win_sync(node_win);
+    MPI_Barrier(node_comm);
+    MPI_Win_sync(node_win);
+    // The leader writes the window again only after the MPI_Gatherv of the next exchange,
+    // i.e. once every rank of the node has delivered the spikes.
+    node_win_received = true;
+    return n;
+}
+
 int nrnmpi_spike_exchange_impl(int* nin,
                                NRNMPI_Spike* spikeout,
                                int icapacity,
@@ -105,19 +278,27 @@ int nrnmpi_spike_exchange_impl(int* nin,
 #endif
     }
 #if nrn_spikebuf_size == 0
-    MPI_Allgather(&nout, 1, MPI_INT, nin, 1, MPI_INT, nrnmpi_comm);
-    int n = nin[0];
-    for (int i = 1; i < np; ++i) {
-        displs[i] = n;
-        n += nin[i];
-    }
-    if (n) {
-        if (icapacity < n) {
-            icapacity = n + 10;
-            free(*spikein);
-            *spikein = (NRNMPI_Spike*) emalloc(icapacity * sizeof(NRNMPI_Spike));
+    // shared memory exchange if all ranks are on one node, see mpishm.cpp
+    node_win_received = false;
+    int n = nrnmpi_shm_spike_exchange(nin, spikeout, nout, icapacity, spikein);
+    if (n < 0 && hierarchical_enabled) {
+        n = hierarchical_spike_exchange(spikeout, nout);
+    } else if (n < 0) {
+        MPI_Allgather(&nout, 1, MPI_INT, nin, 1, MPI_INT, nrnmpi_comm);
+        n = nin[0];
+        for (int i = 1; i < np; ++i) {
+            displs[i] = n;
+            n += nin[i];
+        }
+        if (n) {
+            if (icapacity < n) {
+                icapacity = n + 10;
+                free(*spikein);
+                *spikein = (NRNMPI_Spike*) emalloc(icapacity * sizeof(NRNMPI_Spike));
+            }
+            MPI_Allgatherv(
+                spikeout, nout, spike_type, *spikein, nin, displs, spike_type, nrnmpi_comm);
         }
-        MPI_Allgatherv(spikeout, nout, spike_type, *spikein, nin, displs, spike_type, nrnmpi_comm);
     }
 #else
     MPI_Allgather(spbufout, 1, spikebuf_type, spbufin, 1, spikebuf_type, nrnmpi_comm);
@@ -239,6 +420,123 @@ int nrnmpi_spike_exchange_compressed_impl(int localgid_size,
     return ntot;
 }
 
+/*
+The varint compressed exchange sends a variable number of bytes per rank, see
+coreneuron/network/spike_varint.hpp. Buffer sizes are negotiated every interval
+with an MPI_Allgather of the byte counts, followed by the MPI_Allgatherv of the
+encoded spikes. rcnt and rdispl receive the byte count and the offset into
+rbuf of every rank, rbuf is reallocated when its capacity is too small.
+Returns the total number of bytes received.
+*/
+int nrnmpi_spike_exchange_varint_impl(const unsigned char* sbuf,
+                                      int nbytes,
+                                      int* rcnt,
+                                      int* rdispl,
+                                      unsigned char*& rbuf,
+                                      int& rcapacity) {
+    Instrumentor::phase_begin("spike-exchange");
+
+    {
+        Instrumentor::phase p("imbalance");
+        wait_before_spike_exchange();
+    }
+
+    Instrumentor::phase_begin("communication");
+    MPI_Allgather(&nbytes, 1, MPI_INT, rcnt, 1, MPI_INT, nrnmpi_comm);
+    int ntot = 0;
+    for (int i = 0; i < nrnmpi_numprocs_; ++i) {
+        rdispl[i] = ntot;
+        ntot += rcnt[i];
+    }
+    if (ntot) {
+        if (rcapacity < ntot) {
+            rcapacity = ntot + ntot / 2;
+            free(rbuf);
+            rbuf = static_cast<unsigned char*>(emalloc(rcapacity));
+        }
+        MPI_Allgatherv(sbuf, nbytes, MPI_BYTE, rbuf, rcnt, rdispl, MPI_BYTE, nrnmpi_comm);
+    }
+    Instrumentor::phase_end("communication");
+    Instrumentor::phase_end("spike-exchange");
+    return ntot;
+}
+
+/*
+The neighbour spike exchange only communicates with the ranks that own
+an InputPreSyn for one of our output gids (destinations) and with the ranks
+that own a PreSyn for one of our InputPreSyn (sources). Those lists are
+computed once at setup time and used to build a distributed graph
+communicator. Each exchange is then a MPI_Neighbor_alltoall of the spike
+counts followed by a MPI_Neighbor_alltoallv of the spikes, so that the
+traffic scales with the connectivity rather than with the number of ranks.
+*/
+static MPI_Comm neighbor_comm{MPI_COMM_NULL};
+
+void nrnmpi_neighbor_comm_create_impl(int nsrc, const int* srcs, int ndest, const int* dests) {
+    nrnmpi_neighbor_comm_free_impl();
+    nrn_assert(MPI_Dist_graph_create_adjacent(nrnmpi_comm,
+                                              nsrc,
+                                              srcs,
+                                              MPI_UNWEIGHTED,
+                                              ndest,
+                                              dests,
+                                              MPI_UNWEIGHTED,
+                                              MPI_INFO_NULL,
+                                              0,
+                                              &neighbor_comm) == MPI_SUCCESS);
+}
+
+void nrnmpi_neighbor_comm_free_impl() {
+    if (neighbor_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&neighbor_comm);
+    }
+}
+
+/**
+ * Exchange spikes with the neighbours of the graph communicator
+ *
+ * spikeout is ordered by destination, scnt and sdispl have one entry per
+ * destination and rcnt and rdispl one entry per source, in the order given
+ * to nrnmpi_neighbor_comm_create. The spikein buffer is reallocated when
+ * its capacity is too small.
+ *
+ * @return total number of spikes received
+ */
+int nrnmpi_spike_exchange_neighbor_impl(NRNMPI_Spike* spikeout,
+                                        int* scnt,
+                                        int* sdispl,
+                                        int nsrc,
+                                        int* rcnt,
+                                        int* rdispl,
+                                        NRNMPI_Spike** spikein,
+                                        int& icapacity) {
+    nrn_assert(neighbor_comm != MPI_COMM_NULL);
+    Instrumentor::phase_begin("spike-exchange");
+
+    {
+        Instrumentor::phase p("imbalance");
+        wait_before_spike_exchange();
+    }
+
+    Instrumentor::phase_begin("communication");
+    MPI_Neighbor_alltoall(scnt, 1, MPI_INT, rcnt, 1, MPI_INT, neighbor_comm);
+    int n = 0;
+    for (int i = 0; i < nsrc; ++i) {
+        rdispl[i] = n;
+        n += rcnt[i];
+    }
+    if (icapacity < n) {
+        icapacity = n + 10;
+        free(*spikein);
+        *spikein = (NRNMPI_Spike*) emalloc(icapacity * sizeof(NRNMPI_Spike));
+    }
+    MPI_Neighbor_alltoallv(
+        spikeout, scnt, sdispl, spike_type, *spikein, rcnt, rdispl, spike_type, neighbor_comm);
+    Instrumentor::phase_end("communication");
+    Instrumentor::phase_end("spike-exchange");
+    return n;
+}
+
 int nrnmpi_int_allmax_impl(int x) {
     int result;
     MPI_Allreduce(&x, &result, 1, MPI_INT, MPI_MAX, nrnmpi_comm);
@@ -267,6 +565,134 @@ extern void nrnmpi_dbl_alltoallv_impl(double* s,
     MPI_Alltoallv(s, scnt, sdispl, MPI_DOUBLE, r, rcnt, rdispl, MPI_DOUBLE, nrnmpi_comm);
 }
 
+// at most one non-blocking double alltoallv, i.e. gap junction transfer, is in flight
+static MPI_Request dbl_alltoallv_request{MPI_REQUEST_NULL};
+
+extern void nrnmpi_dbl_ialltoallv_impl(double* s,
+                                       int* scnt,
+                                       int* sdispl,
+                                       double* r,
+                                       int* rcnt,
+                                       int* rdispl) {
+    nrn_assert(dbl_alltoallv_request == MPI_REQUEST_NULL);
+    MPI_Ialltoallv(s,
+                   scnt,
+                   sdispl,
+                   MPI_DOUBLE,
+                   r,
+                   rcnt,
+                   rdispl,
+                   MPI_DOUBLE,
+                   nrnmpi_comm,
+                   &dbl_alltoallv_request);
+}
+
+extern void nrnmpi_dbl_ialltoallv_wait_impl() {
+    MPI_Wait(&dbl_alltoallv_request, MPI_STATUS_IGNORE);
+}
+
+/*
+Gap junction connectivity is sparse and static. The voltage transfer uses a
+distributed graph communicator with the ranks we send voltages to and
+receive voltages from, so that the per step cost depends on the number of
+neighbours rather than on the number of ranks. Send and receive buffers do
+not change during a run, hence with MPI 4 the neighbour alltoallv is a
+persistent request that is only started and completed every step. Before
+MPI 4 every start is a MPI_Ineighbor_alltoallv.
+*/
+static MPI_Comm gap_comm{MPI_COMM_NULL};
+static MPI_Request gap_request{MPI_REQUEST_NULL};
+#if MPI_VERSION < 4
+static double* gap_sbuf;
+static double* gap_rbuf;
+static std::vector<int> gap_counts;  // scnt, sdispl, rcnt, rdispl
+static int gap_ndest;
+static int gap_nsrc;
+#endif
+
+void nrnmpi_gap_neighbor_init_impl(int nsrc,
+                                   const int* srcs,
+                                   const int* rcnt,
+                                   const int* rdispl,
+                                   double* rbuf,
+                                   int ndest,
+                                   const int* dests,
+                                   const int* scnt,
+                                   const int* sdispl,
+                                   double* sbuf) {
+    nrnmpi_gap_neighbor_free_impl();
+    nrn_assert(MPI_Dist_graph_create_adjacent(nrnmpi_comm,
+                                              nsrc,
+                                              srcs,
+                                              MPI_UNWEIGHTED,
+                                              ndest,
+                                              dests,
+                                              MPI_UNWEIGHTED,
+                                              MPI_INFO_NULL,
+                                              0,
+                                              &gap_comm) == MPI_SUCCESS);
+#if MPI_VERSION >= 4
+    nrn_assert(MPI_Neighbor_alltoallv_init(sbuf,
+                                           scnt,
+                                           sdispl,
+                                           MPI_DOUBLE,
+                                           rbuf,
+                                           rcnt,
+                                           rdispl,
+                                           MPI_DOUBLE,
+                                           gap_comm,
+                                           MPI_INFO_NULL,
+                                           &gap_request) == MPI_SUCCESS);
+#else
+    gap_sbuf = sbuf;
+    gap_rbuf = rbuf;
+    gap_ndest = ndest;
+    gap_nsrc = nsrc;
+    gap_counts.assign(scnt, scnt + ndest);
+    gap_counts.insert(gap_counts.end(), sdispl, sdispl + ndest);
+    gap_counts.insert(gap_counts.end(), rcnt, rcnt + nsrc);
+    gap_counts.insert(gap_counts.end(), rdispl, rdispl + nsrc);
+    // add 1 to guarantee a valid pointer for ranks without neighbours
+    gap_counts.reserve(gap_counts.size() + 1);
+#endif
+}
+
+void nrnmpi_gap_neighbor_free_impl() {
+#if MPI_VERSION >= 4
+    if (gap_request != MPI_REQUEST_NULL) {
+        MPI_Request_free(&gap_request);
+    }
+#endif
+    if (gap_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&gap_comm);
+    }
+}
+
+void nrnmpi_gap_neighbor_start_impl() {
+#if MPI_VERSION >= 4
+    MPI_Start(&gap_request);
+#else
+    const int* scnt = gap_counts.data();
+    const int* sdispl = scnt + gap_ndest;
+    const int* rcnt = sdispl + gap_ndest;
+    const int* rdispl = rcnt + gap_nsrc;
+    MPI_Ineighbor_alltoallv(gap_sbuf,
+                            scnt,
+                            sdispl,
+                            MPI_DOUBLE,
+                            gap_rbuf,
+                            rcnt,
+                            rdispl,
+                            MPI_DOUBLE,
+                            gap_comm,
+                            &gap_request);
+#endif
+}
+
+void nrnmpi_gap_neighbor_wait_impl() {
+    MPI_Wait(&gap_request, MPI_STATUS_IGNORE);
+}
+
 /* following are for the partrans */
 
 void nrnmpi_int_allgather_impl(int* s, int* r, int n) {
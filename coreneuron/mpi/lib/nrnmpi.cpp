@@ -73,6 +73,13 @@ nrnmpi_init_ret_t nrnmpi_init_impl(int* pargc, char*** pargv, bool is_quiet) {
 }
 
 void nrnmpi_finalize_impl(void) {
+    // the spike exchange resources are released also when NEURON owns MPI
+    nrnmpi_shm_spike_finalize();
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (nrnmpi_initialized_impl() && !finalized) {
+        nrnmpi_spike_exchange_hierarchical_finalize();
+    }
     if (nrnmpi_under_nrncontrol_) {
         if (nrnmpi_initialized_impl()) {
             MPI_Comm_free(&nrnmpi_world_comm);
@@ -5,4 +5,14 @@ namespace coreneuron {
 extern int nrnmpi_numprocs_;
 extern int nrnmpi_myid_;
 void nrnmpi_spike_initialize();
+void nrnmpi_spike_exchange_hierarchical_finalize();
+
+/* from mpishm.cpp */
+struct NRNMPI_Spike;
+int nrnmpi_shm_spike_exchange(int* nin,
+                              NRNMPI_Spike* spikeout,
+                              int nout,
+                              int& icapacity,
+                              NRNMPI_Spike** spikein);
+void nrnmpi_shm_spike_finalize();
 }  // namespace coreneuron
@@ -35,6 +35,11 @@ extern "C" void nrnmpi_write_file_impl(const std::string& filename,
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_write_file_impl)> nrnmpi_write_file;
 
 
+/* from mpishm.cpp */
+extern "C" bool nrnmpi_shm_spike_init_impl(int capacity);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_shm_spike_init_impl)>
+    nrnmpi_shm_spike_init;
+
 /* from mpispike.cpp */
 extern "C" int nrnmpi_spike_exchange_impl(int* nin,
                                           NRNMPI_Spike* spikeout,
@@ -57,6 +62,42 @@ extern "C" int nrnmpi_spike_exchange_compressed_impl(int,
                                                      int& ovfl);
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_compressed_impl)>
     nrnmpi_spike_exchange_compressed;
+extern "C" int nrnmpi_spike_exchange_varint_impl(const unsigned char* sbuf,
+                                                 int nbytes,
+                                                 int* rcnt,
+                                                 int* rdispl,
+                                                 unsigned char*& rbuf,
+                                                 int& rcapacity);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_varint_impl)>
+    nrnmpi_spike_exchange_varint;
+extern "C" void nrnmpi_neighbor_comm_create_impl(int nsrc,
+                                                 const int* srcs,
+                                                 int ndest,
+                                                 const int* dests);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_neighbor_comm_create_impl)>
+    nrnmpi_neighbor_comm_create;
+extern "C" void nrnmpi_neighbor_comm_free_impl();
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_neighbor_comm_free_impl)>
+    nrnmpi_neighbor_comm_free;
+extern "C" int nrnmpi_spike_exchange_neighbor_impl(NRNMPI_Spike* spikeout,
+                                                   int* scnt,
+                                                   int* sdispl,
+                                                   int nsrc,
+                                                   int* rcnt,
+                                                   int* rdispl,
+                                                   NRNMPI_Spike** spikein,
+                                                   int& icapacity);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_neighbor_impl)>
+    nrnmpi_spike_exchange_neighbor;
+extern "C" int nrnmpi_spike_exchange_hierarchical_init_impl();
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_hierarchical_init_impl)>
+    nrnmpi_spike_exchange_hierarchical_init;
+extern "C" void nrnmpi_spike_exchange_hierarchical_enable_impl(bool enable);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_hierarchical_enable_impl)>
+    nrnmpi_spike_exchange_hierarchical_enable;
+extern "C" const NRNMPI_Spike* nrnmpi_spike_exchange_inplace_impl();
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_spike_exchange_inplace_impl)>
+    nrnmpi_spike_exchange_inplace;
 extern "C" int nrnmpi_int_allmax_impl(int i);
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_int_allmax_impl)> nrnmpi_int_allmax;
 extern "C" void nrnmpi_int_allgather_impl(int* s, int* r, int n);
@@ -77,6 +118,38 @@ extern "C" void nrnmpi_dbl_alltoallv_impl(double* s,
                                           int* rcnt,
                                           int* rdispl);
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_alltoallv_impl)> nrnmpi_dbl_alltoallv;
+extern "C" void nrnmpi_dbl_ialltoallv_impl(double* s,
+                                           int* scnt,
+                                           int* sdispl,
+                                           double* r,
+                                           int* rcnt,
+                                           int* rdispl);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_ialltoallv_impl)>
+    nrnmpi_dbl_ialltoallv;
+extern "C" void nrnmpi_dbl_ialltoallv_wait_impl();
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_ialltoallv_wait_impl)>
+    nrnmpi_dbl_ialltoallv_wait;
+extern "C" void nrnmpi_gap_neighbor_init_impl(int nsrc,
+                                              const int* srcs,
+                                              const int* rcnt,
+                                              const int* rdispl,
+                                              double* rbuf,
+                                              int ndest,
+                                              const int* dests,
+                                              const int* scnt,
+                                              const int* sdispl,
+                                              double* sbuf);
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_gap_neighbor_init_impl)>
+    nrnmpi_gap_neighbor_init;
+extern "C" void nrnmpi_gap_neighbor_free_impl();
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_gap_neighbor_free_impl)>
+    nrnmpi_gap_neighbor_free;
+extern "C" void nrnmpi_gap_neighbor_start_impl();
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_gap_neighbor_start_impl)>
+    nrnmpi_gap_neighbor_start;
+extern "C" void nrnmpi_gap_neighbor_wait_impl();
+extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_gap_neighbor_wait_impl)>
+    nrnmpi_gap_neighbor_wait;
 extern "C" double nrnmpi_dbl_allmin_impl(double x);
 extern mpi_function<cnrn_make_integral_constant_t(nrnmpi_dbl_allmin_impl)> nrnmpi_dbl_allmin;
 extern "C" double nrnmpi_dbl_allmax_impl(double x);
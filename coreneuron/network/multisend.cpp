@@ -231,9 +231,8 @@ void Multisend_ReceiveBuffer::enqueue() {
     for (int i = 0; i < count_; ++i) {
         NRNMPI_Spike* spk = buffer_[i];
 
-        auto gid2in_it = gid2in.find(spk->gid);
-        assert(gid2in_it != gid2in.end());
-        InputPreSyn* ps = gid2in_it->second;
+        InputPreSyn* ps = gid2in_index.find(spk->gid);
+        assert(ps);
 
         if (use_phase2_ && ps->multisend_phase2_index_ >= 0) {
             Phase2Buffer& pb = phase2_buffer_[phase2_head_++];
@@ -266,9 +265,8 @@ void Multisend_ReceiveBuffer::enqueue1() {
     for (int i = 0; i < count_; ++i) {
         NRNMPI_Spike* spk = buffer_[i];
 
-        auto gid2in_it = gid2in.find(spk->gid);
-        assert(gid2in_it != gid2in.end());
-        InputPreSyn* ps = gid2in_it->second;
+        InputPreSyn* ps = gid2in_index.find(spk->gid);
+        assert(ps);
         psbuf_[i] = ps;
         if (use_phase2_ && ps->multisend_phase2_index_ >= 0) {
             Phase2Buffer& pb = phase2_buffer_[phase2_head_++];
@@ -416,6 +414,16 @@ void nrn_multisend_receive(NrnThread* nt) {
 #endif
 }
 
+// With two subintervals, the spikes sent in the interval that the last exchange
+// ended are only received by the next exchange. Receive them now, e.g. before
+// switching to another exchange method. Afterwards no spike is pending and the
+// receive buffers are empty.
+void nrn_multisend_drain(NrnThread* nt) {
+    if (n_multisend_interval == 2) {
+        nrn_multisend_receive(nt);
+    }
+}
+
 void nrn_multisend_cleanup() {
     if (targets_phase1_) {
         delete[] targets_phase1_;
@@ -21,6 +21,7 @@ void nrn_multisend_send(PreSyn*, double t, NrnThread*);
 void nrn_multisend_receive(NrnThread*);  // must be thread 0
 void nrn_multisend_advance();
 void nrn_multisend_init();
+void nrn_multisend_drain(NrnThread*);  // must be thread 0
 
 void nrn_multisend_cleanup();
 void nrn_multisend_setup();
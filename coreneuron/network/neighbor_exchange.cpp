@@ -0,0 +1,195 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+#include "coreneuron/nrnconf.h"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/mpi/core/nrnmpi.hpp"
+#include "coreneuron/network/netcon.hpp"
+#include "coreneuron/network/neighbor_exchange.hpp"
+#include "coreneuron/nrniv/nrniv_decl.h"
+#include "coreneuron/utils/nrn_assert.h"
+#include "coreneuron/utils/nrnoc_aux.hpp"
+
+/*
+Allgather sends every spike to every rank although, for large numbers of
+ranks, most ranks have no InputPreSyn for most gids. The neighbour exchange
+uses the have2want rendezvous once at setup time to find out, for each output
+gid, which ranks want its spikes. Thereafter spikes are only sent to those
+ranks by means of a neighbourhood collective on a distributed graph
+communicator.
+*/
+
+#define HAVEWANT_t         int
+#define HAVEWANT_alltoallv nrnmpi_int_alltoallv
+#define HAVEWANT2Int       std::map<int, int>
+#include "coreneuron/network/have2want.h"
+
+namespace coreneuron {
+bool use_neighbor_exchange_;
+
+#if NRNMPI
+// destination and source ranks of the graph communicator
+static std::vector<int> dests_;
+static std::vector<int> srcs_;
+// for each output gid, the indices into dests_ of the ranks that want it
+static std::map<int, std::vector<int>> gid2dests_;
+// send buffer ordered by destination and the count/displacement vectors
+static std::vector<NRNMPI_Spike> sbuf_;
+static std::vector<int> scnt_;
+static std::vector<int> sdispl_;
+static std::vector<int> rcnt_;
+static std::vector<int> rdispl_;
+#endif
+
+void nrn_neighbor_exchange_setup() {
+#if NRNMPI
+    if (!corenrn_param.mpi_enable) {
+        return;
+    }
+#if nrn_spikebuf_size > 0
+    hoc_execerror("neighbor spike exchange", "is not compatible with nrn_spikebuf_size > 0");
+#endif
+    nrn_neighbor_exchange_cleanup();
+
+    // have are the output gids of this rank, want are the gids of the InputPreSyn
+    std::vector<int> have;
+    for (const auto& gid2out_elem: gid2out) {
+        if (gid2out_elem.second->output_index_ >= 0) {
+            have.push_back(gid2out_elem.first);
+        }
+    }
+    std::vector<int> want;
+    want.reserve(gid2in.size());
+    for (const auto& gid2in_elem: gid2in) {
+        want.push_back(gid2in_elem.first);
+    }
+    // add 1 to guarantee a valid pointer.
+    have.reserve(have.size() + 1);
+    want.reserve(want.size() + 1);
+
+    int *send_to_want, *send_to_want_cnt, *send_to_want_displ;
+    int *recv_from_have, *recv_from_have_cnt, *recv_from_have_displ;
+    have_to_want(have.data(),
+                 have.size(),
+                 want.data(),
+                 want.size(),
+                 send_to_want,
+                 send_to_want_cnt,
+                 send_to_want_displ,
+                 recv_from_have,
+                 recv_from_have_cnt,
+                 recv_from_have_displ,
+                 default_rendezvous);
+
+    for (int r = 0; r < nrnmpi_numprocs; ++r) {
+        if (r == nrnmpi_myid) {
+            continue;
+        }
+        if (send_to_want_cnt[r] > 0) {
+            int idest = dests_.size();
+            dests_.push_back(r);
+            for (int i = send_to_want_displ[r]; i < send_to_want_displ[r + 1]; ++i) {
+                gid2dests_[send_to_want[i]].push_back(idest);
+            }
+        }
+        if (recv_from_have_cnt[r] > 0) {
+            srcs_.push_back(r);
+        }
+    }
+    delete[] send_to_want;
+    delete[] send_to_want_cnt;
+    delete[] send_to_want_displ;
+    delete[] recv_from_have;
+    delete[] recv_from_have_cnt;
+    delete[] recv_from_have_displ;
+
+    scnt_.resize(dests_.size() + 1);
+    sdispl_.resize(dests_.size() + 1);
+    rcnt_.resize(srcs_.size() + 1);
+    rdispl_.resize(srcs_.size() + 1);
+    nrnmpi_neighbor_comm_create(srcs_.size(), srcs_.data(), dests_.size(), dests_.data());
+
+    int ndest = dests_.size();
+    int ndest_max = nrnmpi_int_allmax(ndest);
+    double ndest_mean = nrnmpi_dbl_allreduce(double(ndest), 1) / nrnmpi_numprocs;
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Neighbor spike exchange: %.1f destination ranks per rank on average, %d max\n",
+               ndest_mean,
+               ndest_max);
+    }
+#endif
+}
+
+void nrn_neighbor_exchange_cleanup() {
+#if NRNMPI
+    if (!corenrn_param.mpi_enable) {
+        return;
+    }
+    nrnmpi_neighbor_comm_free();
+    dests_.clear();
+    srcs_.clear();
+    gid2dests_.clear();
+    sbuf_.clear();
+    scnt_.clear();
+    sdispl_.clear();
+    rcnt_.clear();
+    rdispl_.clear();
+#endif
+}
+
+#if NRNMPI
+int nrn_neighbor_exchange(NRNMPI_Spike* spikeout,
+                          int nout,
+                          NRNMPI_Spike** spikein,
+                          int& icapacity) {
+    int ndest = dests_.size();
+    std::fill(scnt_.begin(), scnt_.end(), 0);
+    int nsend = 0;
+    for (int i = 0; i < nout; ++i) {
+        auto it = gid2dests_.find(spikeout[i].gid);
+        if (it != gid2dests_.end()) {
+            for (int idest: it->second) {
+                ++scnt_[idest];
+            }
+            nsend += it->second.size();
+        }
+    }
+    sdispl_[0] = 0;
+    for (int i = 0; i < ndest; ++i) {
+        sdispl_[i + 1] = sdispl_[i] + scnt_[i];
+    }
+    if (sbuf_.size() < static_cast<std::size_t>(nsend + 1)) {
+        sbuf_.resize(nsend + 1);
+    }
+    // recount while filling
+    std::fill(scnt_.begin(), scnt_.end(), 0);
+    for (int i = 0; i < nout; ++i) {
+        auto it = gid2dests_.find(spikeout[i].gid);
+        if (it != gid2dests_.end()) {
+            for (int idest: it->second) {
+                sbuf_[sdispl_[idest] + scnt_[idest]++] = spikeout[i];
+            }
+        }
+    }
+    return nrnmpi_spike_exchange_neighbor(sbuf_.data(),
+                                          scnt_.data(),
+                                          sdispl_.data(),
+                                          static_cast<int>(srcs_.size()),
+                                          rcnt_.data(),
+                                          rdispl_.data(),
+                                          spikein,
+                                          icapacity);
+}
+#endif
+}  // namespace coreneuron
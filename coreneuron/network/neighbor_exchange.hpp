@@ -0,0 +1,33 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+namespace coreneuron {
+struct NRNMPI_Spike;
+
+/// Use the sparse neighbour spike exchange instead of Allgather.
+extern bool use_neighbor_exchange_;
+
+/// Determine the source and destination ranks of every spike (requires gid2out and gid2in)
+void nrn_neighbor_exchange_setup();
+void nrn_neighbor_exchange_cleanup();
+
+#if NRNMPI
+/** @brief Send the nout spikes of spikeout to the ranks that have an InputPreSyn for them
+ *
+ *  Received spikes are stored in spikein, which is reallocated if its capacity
+ *  is too small.
+ *  @return number of spikes received
+ */
+int nrn_neighbor_exchange(NRNMPI_Spike* spikeout,
+                          int nout,
+                          NRNMPI_Spike** spikein,
+                          int& icapacity);
+#endif
+}  // namespace coreneuron
@@ -44,19 +44,18 @@ struct DiscreteEvent {
     virtual void pr(const char*, double t, NetCvode*);
 };
 
+/**
+ * \class NetCon
+ * \brief Handle of a connection whose data is stored per NrnThread
+ *
+ * The delay, target and weight index of the NetCons of a NrnThread are the
+ * parallel arrays netcon_delay, netcon_target and netcon_weight_index of that
+ * thread, indexed like NrnThread::netcons. The object itself only carries the
+ * vptr, which is needed to queue it as a DiscreteEvent, and the thread and
+ * index of its data. The accessors are defined in multicore.hpp.
+ */
 class NetCon: public DiscreteEvent {
   public:
-    bool active_{};
-    double delay_{1.0};
-    Point_process* target_{};
-    union {
-        int weight_index_{};
-        int srcgid_;  // only to help InputPreSyn during setup
-        // before weights are read and stored. Saves on transient
-        // memory requirements by avoiding storage of all group file
-        // netcon_srcgid lists. ie. that info is copied into here.
-    } u;
-
     NetCon() = default;
     virtual ~NetCon() = default;
     virtual void send(double sendtime, NetCvode*, NrnThread*) override;
@@ -65,6 +64,25 @@ class NetCon: public DiscreteEvent {
         return NetConType;
     }
     virtual void pr(const char*, double t, NetCvode*) override;
+
+    /// Attach the handle to element index of the NetCon arrays of NrnThread tid
+    void bind(int tid, int index) {
+        tid_ = tid;
+        index_ = index;
+    }
+    int index() const {
+        return index_;
+    }
+    inline NrnThread* thread() const;
+    /// True if the NetCon has a target, only those deliver events
+    inline bool active() const;
+    inline double delay() const;
+    inline Point_process* target() const;
+    inline int weight_index() const;
+
+  private:
+    int tid_{};
+    int index_{};
 };
 
 class SelfEvent: public DiscreteEvent {
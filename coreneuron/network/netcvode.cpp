@@ -19,6 +19,7 @@
 #include "coreneuron/utils/profile/profiler_interface.h"
 #include "coreneuron/nrniv/nrniv_decl.h"
 #include "coreneuron/io/output_spikes.hpp"
+#include "coreneuron/io/cost_profile.hpp"
 #include "coreneuron/utils/nrn_assert.h"
 #include "coreneuron/gpu/nrn_acc_manager.hpp"
 #include "coreneuron/network/multisend.hpp"
@@ -252,14 +253,16 @@ void NetCvode::init_events() {
         }
 
         for (int inetc = 0; inetc < nt->n_netcon; ++inetc) {
-            NetCon* d = nt->netcons + inetc;
-            if (d->target_) {
-                int type = d->target_->_type;
+            int itarget = nrn_netcon_target(nt, inetc);
+            if (itarget >= 0) {
+                Point_process* target = nt->pntprocs + itarget;
+                int weight_index = nrn_netcon_weight_index(nt, inetc);
+                int type = target->_type;
                 if (corenrn.get_pnt_receive_init()[type]) {
-                    (*corenrn.get_pnt_receive_init()[type])(d->target_, d->u.weight_index_, 0);
+                    (*corenrn.get_pnt_receive_init()[type])(target, weight_index, 0);
                 } else {
                     int cnt = corenrn.get_pnt_receive_size()[type];
-                    double* wt = nt->weights + d->u.weight_index_;
+                    double* wt = nt->weights + weight_index;
                     // not the first
                     for (int j = 1; j < cnt; ++j) {
                         wt[j] = 0.;
@@ -370,27 +373,31 @@ void DiscreteEvent::pr(const char* s, double tt, NetCvode* /* ns */) {
 }
 
 void NetCon::send(double tt, NetCvode* ns, NrnThread* nt) {
-    if (active_ && target_) {
-        nrn_assert(PP2NT(target_) == nt);
-        ns->bin_event(tt, this, PP2NT(target_));
+    if (active()) {
+        nrn_assert(thread() == nt);
+        ns->bin_event(tt, this, thread());
     }
 }
 
 void NetCon::deliver(double tt, NetCvode* /* ns */, NrnThread* nt) {
-    nrn_assert(target_);
+    if (thread() != nt)
+        printf("NetCon::deliver nt=%d target=%d\n", nt->id, tid_);
 
-    if (PP2NT(target_) != nt)
-        printf("NetCon::deliver nt=%d target=%d\n", nt->id, PP2NT(target_)->id);
-
-    nrn_assert(PP2NT(target_) == nt);
-    int typ = target_->_type;
+    nrn_assert(thread() == nt);
+    int itarget = nrn_netcon_target(nt, index_);
+    nrn_assert(itarget >= 0);
+    Point_process* target = nt->pntprocs + itarget;
+    if (nrn_cost_profile_enabled) {
+        nrn_cost_profile_event(nt, target);
+    }
+    int typ = target->_type;
     nt->_t = tt;
 
-    // printf("NetCon::deliver t=%g tt=%g %s\n", t, tt, pnt_name(target_));
+    // printf("NetCon::deliver t=%g tt=%g %s\n", t, tt, pnt_name(target));
     std::string ss("net-receive-");
     ss += nrn_get_mechname(typ);
     Instrumentor::phase p_get_pnt_receive(ss.c_str());
-    (*corenrn.get_pnt_receive()[typ])(target_, u.weight_index_, 0);
+    (*corenrn.get_pnt_receive()[typ])(target, nrn_netcon_weight_index(nt, index_), 0);
 #ifdef DEBUG
     if (errno && nrn_errno_check(typ))
         hoc_warning("errno set during NetCon deliver to NET_RECEIVE", (char*) 0);
@@ -398,7 +405,7 @@ void NetCon::deliver(double tt, NetCvode* /* ns */, NrnThread* nt) {
 }
 
 void NetCon::pr(const char* s, double tt, NetCvode* /* ns */) {
-    Point_process* pp = target_;
+    Point_process* pp = target();
     printf("%s NetCon target=%s[%d] %.15g\n",
            s,
            corenrn.get_memb_func(pp->_type).sym,
@@ -410,13 +417,13 @@ void PreSyn::send(double tt, NetCvode* ns, NrnThread* nt) {
     record(tt);
     for (int i = nc_cnt_ - 1; i >= 0; --i) {
         NetCon* d = netcon_in_presyn_order_[nc_index_ + i];
-        if (d->active_ && d->target_) {
-            NrnThread* n = PP2NT(d->target_);
+        if (d->active()) {
+            NrnThread* n = d->thread();
 
             if (nt == n)
-                ns->bin_event(tt + d->delay_, d, n);
+                ns->bin_event(tt + d->delay(), d, n);
             else
-                ns->p[n->id].interthread_send(tt + d->delay_, d, n);
+                ns->p[n->id].interthread_send(tt + d->delay(), d, n);
         }
     }
 
@@ -442,13 +449,13 @@ void PreSyn::send(double tt, NetCvode* ns, NrnThread* nt) {
 void InputPreSyn::send(double tt, NetCvode* ns, NrnThread* nt) {
     for (int i = nc_cnt_ - 1; i >= 0; --i) {
         NetCon* d = netcon_in_presyn_order_[nc_index_ + i];
-        if (d->active_ && d->target_) {
-            NrnThread* n = PP2NT(d->target_);
+        if (d->active()) {
+            NrnThread* n = d->thread();
 
             if (nt == n)
-                ns->bin_event(tt + d->delay_, d, n);
+                ns->bin_event(tt + d->delay(), d, n);
             else
-                ns->p[n->id].interthread_send(tt + d->delay_, d, n);
+                ns->p[n->id].interthread_send(tt + d->delay(), d, n);
         }
     }
 }
@@ -490,6 +497,9 @@ void ncs2nrn_integrate(double tstop) {
 
     if (total_sim_steps > 3 && !nrn_have_gaps) {
         nrn_fixed_step_group_minimal(total_sim_steps);
+    } else if (total_sim_steps > 3 && !nrn_thread_team_active()) {
+        // with a thread team, single steps have no fork/join overhead
+        nrn_fixed_step_group_gap(total_sim_steps);
     } else {
         nrn_fixed_single_steps_minimal(total_sim_steps, tstop);
     }
@@ -552,9 +562,12 @@ void NetCvode::check_thresh(NrnThread* nt) {  // for default method
 #ifndef CORENEURON_ENABLE_GPU
             nt->_net_send_buffer_cnt = net_send_buf_count;
             if (nt->_net_send_buffer_cnt >= nt->_net_send_buffer_size) {
+                // allocated by ecalloc_align, possibly from an arena, so no realloc
+                int* buf = (int*) ecalloc_align(2 * nt->_net_send_buffer_size, sizeof(int));
+                memcpy(buf, nt->_net_send_buffer, nt->_net_send_buffer_size * sizeof(int));
+                free_memory(nt->_net_send_buffer);
+                nt->_net_send_buffer = buf;
                 nt->_net_send_buffer_size *= 2;
-                nt->_net_send_buffer = (int*) erealloc(nt->_net_send_buffer,
-                                                       nt->_net_send_buffer_size * sizeof(int));
             }
 #endif
 
@@ -581,6 +594,9 @@ void NetCvode::check_thresh(NrnThread* nt) {  // for default method
     for (int i = 0; i < nt->_net_send_buffer_cnt; ++i) {
         PreSyn* ps = nt->presyns + nt->_net_send_buffer[i];
         ps->send(nt->_t + teps, net_cvode_instance, nt);
+        if (nrn_cost_profile_enabled) {
+            nrn_cost_profile_spike(nt, ps);
+        }
     }
 
     // Types that have WATCH statements. If exist, then last element is 0.
@@ -6,6 +6,7 @@
 # =============================================================================.
 */
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <map>
@@ -22,6 +23,8 @@
 #include "coreneuron/nrniv/nrniv_decl.h"
 #include "coreneuron/utils/ivocvect.hpp"
 #include "coreneuron/network/multisend.hpp"
+#include "coreneuron/network/neighbor_exchange.hpp"
+#include "coreneuron/network/spike_varint.hpp"
 #include "coreneuron/utils/nrn_assert.h"
 #include "coreneuron/utils/nrnoc_aux.hpp"
 #include "coreneuron/utils/profile/profiler_interface.h"
@@ -59,6 +62,8 @@ static double dt1_;  // 1/dt
 
 NRNMPI_Spike* spikeout;
 NRNMPI_Spike* spikein;
+// spikein, or the node shared window of the hierarchical exchange
+static const NRNMPI_Spike* spikes_received_;
 
 void nrn_timeout(int);
 void nrn_spike_exchange(NrnThread*);
@@ -69,15 +74,69 @@ bool nrn_use_localgid_;
 void nrn_outputevent(unsigned char localgid, double firetime);
 std::vector<std::map<int, InputPreSyn*>> localmaps;
 
+/*
+With more than one thread the received spikes are resolved by all threads in
+parallel. Each thread only looks up the gids that have a NetCon targeting it,
+using a per thread copy of the gid to InputPreSyn index, and puts the events
+directly into its own queue. This avoids the serial walk over the received
+spikes followed by the interthread_send buffers.
+*/
+struct ThreadInputPreSyn {
+    int nc_index_;  // into ThreadSpikeFilter::netcons_
+    int nc_cnt_;
+};
+struct ThreadSpikeFilter {
+    std::vector<ThreadInputPreSyn> ips_;
+    std::vector<NetCon*> netcons_;
+    FlatGidMap<ThreadInputPreSyn> gid2ips_;
+};
+static std::vector<ThreadSpikeFilter> thread_filters_;
+static void thread_filters_build();
+static void thread_receive_spikes(NrnThread* nt, int n);
+
 static int ocapacity_;  // for spikeout
 // require it to be smaller than  min_interprocessor_delay.
 static double wt_;   // wait time for nrnmpi_spike_exchange
 static double wt1_;  // time to find the PreSyns and send the spikes.
 static bool use_compress_;
 static int spfixout_capacity_;
+
+/*
+Runtime selection of the spike exchange method. Allgather and the methods set
+up with --spkcompress and --multisend are the candidates. They take turns,
+one exchange interval each, so that all of them see the same part of the
+simulation, until each one did autotune_interval_ exchanges. Each exchange is
+timed, like wt_ + wt1_, for multisend including the receive of the spikes of
+its last subinterval when switching away from it. Then the candidate with the
+smallest time, maximised over ranks, is kept for the rest of the run. The
+method is switched right after an exchange, when no spike is buffered or in
+flight. While autotuning, the exchange interval is the smallest of the
+candidates, as the next NetParEvent is already scheduled when the method is
+switched.
+*/
+enum ExchangeMethod { exchange_allgather, exchange_compress, exchange_multisend };
+static const char* exchange_method_name[] = {"Allgather", "compressed", "multisend"};
+static std::vector<ExchangeMethod> autotune_candidates_;
+static std::vector<double> autotune_time_;
+static int autotune_interval_;   // 0 when not autotuning
+static int autotune_candidate_;  // index into autotune_candidates_
+static int autotune_nexchange_;  // exchanges done with all candidates
+static bool compress_localgid_;  // gid compression of the compressed exchange succeeded
+static void autotune_exchange(NrnThread* nt);
+static void spike_exchange(NrnThread* nt);
 static int idxout_;
 static void nrn_spike_exchange_compressed(NrnThread*);
 
+// varint compressed exchange of the spikeout spikes, see spike_varint.hpp
+static bool use_varint_;
+static std::vector<unsigned char> varint_sbuf_;
+static std::vector<int> varint_rcnt_;
+static std::vector<int> varint_rdispl_;
+static unsigned char* varint_rbuf_;
+static int varint_rcapacity_;
+static std::size_t varint_nspike_;  // spikes sent, to report the compression
+static std::size_t varint_nbytes_;  // bytes sent
+
 #endif  // NRNMPI
 
 static bool active_ = false;
@@ -235,21 +294,45 @@ static bool nrn_need_npe() {
 
 #define TBUFSIZE 0
 
+/// Interval between the exchanges of the multisend, the compressed or the Allgather exchange
+static double exchange_interval(bool multisend, bool compress) {
+    double interval = mindelay_;
+#if NRN_MULTISEND
+    if (multisend && n_multisend_interval == 2) {
+        interval *= 0.5;
+    }
+#endif
+    if (nrn_nthread > 1) {
+        interval -= dt;
+    }
+    if (compress) {
+        // spike times are sent as multiples of dt since the last exchange in one byte
+        interval = floor(mindelay_ * rev_dt + 1e-9) * dt;
+        if (interval * rev_dt >= 255.) {
+            interval = 255. / rev_dt;
+        }
+    }
+    return interval;
+}
+
 void nrn_spike_exchange_init() {
     // printf("nrn_spike_exchange_init\n");
     if (!nrn_need_npe()) {
         return;
     }
     alloc_mpi_space();
-    usable_mindelay_ = mindelay_;
-#if NRN_MULTISEND
-    if (use_multisend_ && n_multisend_interval == 2) {
-        usable_mindelay_ *= 0.5;
+#if NRNMPI
+    usable_mindelay_ = exchange_interval(use_multisend_, use_compress_);
+    for (ExchangeMethod method: autotune_candidates_) {
+        if (autotune_interval_) {
+            usable_mindelay_ = std::min(usable_mindelay_,
+                                        exchange_interval(method == exchange_multisend,
+                                                          method == exchange_compress));
+        }
     }
+#else
+    usable_mindelay_ = exchange_interval(false, false);
 #endif
-    if (nrn_nthread > 1) {
-        usable_mindelay_ -= dt;
-    }
     if ((usable_mindelay_ < 1e-9) || (usable_mindelay_ < dt)) {
         if (nrnmpi_myid == 0) {
             hoc_execerror("usable mindelay is 0", "(or less than dt for fixed step method)");
@@ -263,7 +346,10 @@ void nrn_spike_exchange_init() {
 #endif
 
 #if NRN_MULTISEND
-    if (use_multisend_) {
+    bool multisend_candidate = std::find(autotune_candidates_.begin(),
+                                         autotune_candidates_.end(),
+                                         exchange_multisend) != autotune_candidates_.end();
+    if (use_multisend_ || (autotune_interval_ && multisend_candidate)) {
         nrn_multisend_init();
     }
 #endif
@@ -287,10 +373,6 @@ void nrn_spike_exchange_init() {
             idxout_ = 2;
             t_exchange_ = t;
             dt1_ = rev_dt;
-            usable_mindelay_ = floor(mindelay_ * dt1_ + 1e-9) * dt;
-            if (usable_mindelay_ * dt1_ >= 255.) {
-                usable_mindelay_ = 255. / dt1_;
-            }
             assert(usable_mindelay_ >= dt && (usable_mindelay_ * dt1_) <= 255.);
         } else {
 #if nrn_spikebuf_size > 0
@@ -299,18 +381,227 @@ void nrn_spike_exchange_init() {
             }
 #endif
         }
+        if (use_varint_) {
+            t_exchange_ = t;
+            dt1_ = rev_dt;
+        }
         nout = 0;
+        thread_filters_.clear();
+#if nrn_spikebuf_size == 0
+        if (nrn_nthread > 1) {
+            thread_filters_build();
+        }
+#endif
     }
 #endif  // NRNMPI
         // if (nrnmpi_myid == 0){printf("usable_mindelay_ = %g\n", usable_mindelay_);}
 }
 
 #if NRNMPI
+void nrn_spike_varint_compress(bool on) {
+#if nrn_spikebuf_size > 0
+    if (on) {
+        hoc_execerror("varint spike compression", "is not compatible with nrn_spikebuf_size > 0");
+    }
+#endif
+    use_varint_ = on;
+    varint_rcnt_.resize(on ? nrnmpi_numprocs : 0);
+    varint_rdispl_.resize(on ? nrnmpi_numprocs : 0);
+    varint_nspike_ = 0;
+    varint_nbytes_ = 0;
+}
+
+void nrn_spike_varint_report() {
+    if (!use_varint_) {
+        return;
+    }
+    double nspike = nrnmpi_dbl_allreduce(double(varint_nspike_), 1);
+    double nbytes = nrnmpi_dbl_allreduce(double(varint_nbytes_), 1);
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet() && nspike > 0.) {
+        printf(" Varint spike compression: %.0f spikes sent in %.0f bytes, %.2f bytes per spike\n",
+               nspike,
+               nbytes,
+               nbytes / nspike);
+    }
+}
+
+// Encode spikeout, exchange and decode into spikein. Returns the number of spikes received.
+static int spike_exchange_varint() {
+    varint_sbuf_.clear();
+    spike_varint::encode(spikeout, nout, t_exchange_, dt1_, varint_sbuf_);
+    int nbytes = varint_sbuf_.size();
+    varint_nspike_ += nout;
+    varint_nbytes_ += nbytes;
+    int ntot = nrnmpi_spike_exchange_varint(varint_sbuf_.data(),
+                                            nbytes,
+                                            varint_rcnt_.data(),
+                                            varint_rdispl_.data(),
+                                            varint_rbuf_,
+                                            varint_rcapacity_);
+    int n = 0;
+    if (ntot) {
+        int nmax = ntot / spike_varint::min_spike_bytes;
+        if (icapacity < nmax) {
+            icapacity = nmax + 10;
+            free(spikein);
+            spikein = (NRNMPI_Spike*) emalloc(icapacity * sizeof(NRNMPI_Spike));
+        }
+        // as in the compressed exchange, restore the threshold detection offset lost by rounding
+        for (int i = 0; i < nrnmpi_numprocs; ++i) {
+            n += spike_varint::decode(varint_rbuf_ + varint_rdispl_[i],
+                                      varint_rcnt_[i],
+                                      t_exchange_ + 1e-10,
+                                      dt,
+                                      spikein + n);
+        }
+    }
+    t_exchange_ = nrn_threads->_t;
+    return n;
+}
+
+// called right after an exchange or before nrn_spike_exchange_init
+static void exchange_method_select(ExchangeMethod method, NrnThread* nt = nullptr) {
+#if NRN_MULTISEND
+    // the multisend receive buffers are empty when it is switched to again
+    if (use_multisend_ && method != exchange_multisend && nt) {
+        nrn_multisend_drain(nt);
+    }
+    use_multisend_ = (method == exchange_multisend);
+#endif
+    use_compress_ = (method == exchange_compress);
+    nrn_use_localgid_ = use_compress_ && compress_localgid_;
+    idxout_ = 2;
+    t_exchange_ = nrn_threads ? nrn_threads->_t : t;
+    dt1_ = rev_dt;
+}
+
+void nrn_spike_exchange_autotune(int nexchange) {
+    autotune_candidates_.clear();
+    autotune_candidates_.push_back(exchange_allgather);
+    if (use_compress_) {
+        autotune_candidates_.push_back(exchange_compress);
+    }
+#if NRN_MULTISEND
+    if (use_multisend_) {
+        autotune_candidates_.push_back(exchange_multisend);
+    }
+#endif
+    if (autotune_candidates_.size() < 2) {
+        autotune_candidates_.clear();
+        if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+            printf(" Notice: spike exchange autotuning requires --spkcompress or --multisend\n");
+        }
+        return;
+    }
+    compress_localgid_ = nrn_use_localgid_;
+    autotune_time_.assign(autotune_candidates_.size(), 0.);
+    autotune_interval_ = nexchange;
+    autotune_candidate_ = 0;
+    autotune_nexchange_ = 0;
+    exchange_method_select(autotune_candidates_[0]);
+}
+
+// an exchange with the current candidate, after which the next one takes over
+static void autotune_exchange(NrnThread* nt) {
+    int ncandidate = autotune_candidates_.size();
+    int next = (autotune_candidate_ + 1) % ncandidate;
+    double wt = nrn_wtime();
+    spike_exchange(nt);
+    exchange_method_select(autotune_candidates_[next], nt);
+    autotune_time_[autotune_candidate_] += nrn_wtime() - wt;
+    autotune_candidate_ = next;
+    if (++autotune_nexchange_ < autotune_interval_ * ncandidate) {
+        return;
+    }
+
+    // all candidates timed, the slowest rank decides
+    int best = 0;
+    for (int i = 0; i < ncandidate; ++i) {
+        autotune_time_[i] = nrnmpi_dbl_allmax(autotune_time_[i]);
+        if (autotune_time_[i] < autotune_time_[best]) {
+            best = i;
+        }
+    }
+    ExchangeMethod method = autotune_candidates_[best];
+    exchange_method_select(method, nt);
+    // from the interval after the next one, which is already scheduled
+    usable_mindelay_ = exchange_interval(method == exchange_multisend, method == exchange_compress);
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Spike exchange autotuning, time of %d exchange intervals:\n", autotune_interval_);
+        for (std::size_t i = 0; i < autotune_candidates_.size(); ++i) {
+            printf("   %-12s %g s\n",
+                   exchange_method_name[autotune_candidates_[i]],
+                   autotune_time_[i]);
+        }
+        printf(" Using %s spike exchange\n", exchange_method_name[method]);
+    }
+    autotune_interval_ = 0;
+}
+
+/// Group the NetCon of every InputPreSyn by target thread
+static void thread_filters_build() {
+    thread_filters_.resize(nrn_nthread);
+    std::vector<std::vector<int>> gids(nrn_nthread);
+    for (const auto& gid2in_elem: gid2in) {
+        int gid = gid2in_elem.first;
+        InputPreSyn* psi = gid2in_elem.second;
+        // same order as InputPreSyn::send
+        for (int i = psi->nc_cnt_ - 1; i >= 0; --i) {
+            NetCon* d = netcon_in_presyn_order_[psi->nc_index_ + i];
+            if (!d->active()) {
+                continue;
+            }
+            int tid = d->thread()->id;
+            auto& tf = thread_filters_[tid];
+            if (gids[tid].empty() || gids[tid].back() != gid) {
+                gids[tid].push_back(gid);
+                tf.ips_.push_back({static_cast<int>(tf.netcons_.size()), 0});
+            }
+            tf.netcons_.push_back(d);
+            ++tf.ips_.back().nc_cnt_;
+        }
+    }
+    for (int tid = 0; tid < nrn_nthread; ++tid) {
+        auto& tf = thread_filters_[tid];
+        std::map<int, ThreadInputPreSyn*> gid2ips;
+        for (std::size_t i = 0; i < gids[tid].size(); ++i) {
+            gid2ips[gids[tid][i]] = &tf.ips_[i];
+        }
+        tf.gid2ips_.build(gid2ips);
+    }
+}
+
+/// Deliver the received spikes to the NetCon targeting thread nt
+static void thread_receive_spikes(NrnThread* nt, int n) {
+    const auto& tf = thread_filters_[nt->id];
+    for (int i = 0; i < n; ++i) {
+        const ThreadInputPreSyn* tps = tf.gid2ips_.find(spikes_received_[i].gid);
+        if (tps) {
+            for (int j = tps->nc_index_; j < tps->nc_index_ + tps->nc_cnt_; ++j) {
+                NetCon* d = tf.netcons_[j];
+                if (d->active()) {
+                    net_cvode_instance->bin_event(
+                        spikes_received_[i].spiketime + d->delay(), d, nt);
+                }
+            }
+        }
+    }
+    interthread_enqueue(nt);
+}
+
 void nrn_spike_exchange(NrnThread* nt) {
     Instrumentor::phase p_spike_exchange("spike-exchange");
     if (!active_) {
         return;
     }
+    if (autotune_interval_) {
+        autotune_exchange(nt);
+    } else {
+        spike_exchange(nt);
+    }
+}
+
+static void spike_exchange(NrnThread* nt) {
 #if NRN_MULTISEND
     if (use_multisend_) {
         nrn_multisend_receive(nt);
@@ -330,8 +621,21 @@ void nrn_spike_exchange(NrnThread* nt) {
 #endif
     double wt = nrn_wtime();
 
-    int n = nrnmpi_spike_exchange(
-        nrnmpi_nin_, spikeout, icapacity, &spikein, ovfl, nout, spbufout, spbufin);
+    int n;
+    if (use_neighbor_exchange_) {
+        n = nrn_neighbor_exchange(spikeout, nout, &spikein, icapacity);
+    } else if (use_varint_) {
+        n = spike_exchange_varint();
+    } else {
+        n = nrnmpi_spike_exchange(
+            nrnmpi_nin_, spikeout, icapacity, &spikein, ovfl, nout, spbufout, spbufin);
+    }
+    spikes_received_ = spikein;
+    if (!use_neighbor_exchange_ && !use_varint_) {
+        if (const NRNMPI_Spike* inplace = nrnmpi_spike_exchange_inplace()) {
+            spikes_received_ = inplace;
+        }
+    }
 
     wt_ = nrn_wtime() - wt;
     wt = nrn_wtime();
@@ -346,6 +650,7 @@ void nrn_spike_exchange(NrnThread* nt) {
     //}
     nout = 0;
     if (n == 0) {
+        wt1_ = 0.;
         return;
     }
 #if nrn_spikebuf_size > 0
@@ -355,20 +660,24 @@ void nrn_spike_exchange(NrnThread* nt) {
             nn = nrn_spikebuf_size;
         }
         for (int j = 0; j < nn; ++j) {
-            auto gid2in_it = gid2in.find(spbufin[i].gid[j]);
-            if (gid2in_it != gid2in.end()) {
-                InputPreSyn* ps = gid2in_it->second;
+            InputPreSyn* ps = gid2in_index.find(spbufin[i].gid[j]);
+            if (ps) {
                 ps->send(spbufin[i].spiketime[j], net_cvode_instance, nt);
             }
         }
     }
     n = ovfl;
+#else
+    if (thread_filters_.size() == static_cast<std::size_t>(nrn_nthread)) {
+        nrn_multithread_job(thread_receive_spikes, n);
+        wt1_ = nrn_wtime() - wt;
+        return;
+    }
 #endif  // nrn_spikebuf_size > 0
     for (int i = 0; i < n; ++i) {
-        auto gid2in_it = gid2in.find(spikein[i].gid);
-        if (gid2in_it != gid2in.end()) {
-            InputPreSyn* ps = gid2in_it->second;
-            ps->send(spikein[i].spiketime, net_cvode_instance, nt);
+        InputPreSyn* ps = gid2in_index.find(spikes_received_[i].gid);
+        if (ps) {
+            ps->send(spikes_received_[i].spiketime, net_cvode_instance, nt);
         }
     }
     nrn_multithread_job(interthread_enqueue);
@@ -426,7 +735,7 @@ void nrn_spike_exchange_compressed(NrnThread* nt) {
                     }
                     continue;
                 }
-                std::map<int, InputPreSyn*> gps = localmaps[i];
+                const auto& gps = localmaps[i];
                 if (nn > ag_send_nspike) {
                     nnn = ag_send_nspike;
                 } else {
@@ -468,9 +777,8 @@ void nrn_spike_exchange_compressed(NrnThread* nt) {
                 double firetime = spikein_fixed[idx++] * dt + t_exchange_;
                 int gid = spupk(spikein_fixed + idx);
                 idx += localgid_size_;
-                auto gid2in_it = gid2in.find(gid);
-                if (gid2in_it != gid2in.end()) {
-                    InputPreSyn* ps = gid2in_it->second;
+                InputPreSyn* ps = gid2in_index.find(gid);
+                if (ps) {
                     ps->send(firetime + 1e-10, net_cvode_instance, nt);
                 }
             }
@@ -481,9 +789,8 @@ void nrn_spike_exchange_compressed(NrnThread* nt) {
             double firetime = spfixin_ovfl_[idx++] * dt + t_exchange_;
             int gid = spupk(spfixin_ovfl_ + idx);
             idx += localgid_size_;
-            auto gid2in_it = gid2in.find(gid);
-            if (gid2in_it != gid2in.end()) {
-                InputPreSyn* ps = gid2in_it->second;
+            InputPreSyn* ps = gid2in_index.find(gid);
+            if (ps) {
                 ps->send(firetime + 1e-10, net_cvode_instance, nt);
             }
         }
@@ -602,8 +909,6 @@ int nrn_set_timeout(int timeout) {
 }
 
 void BBS_netpar_solve(double tstop) {
-    double time = nrn_wtime();
-
 #if NRNMPI
     if (corenrn_param.mpi_enable) {
         tstopunset;
@@ -634,10 +939,6 @@ void BBS_netpar_solve(double tstop) {
         ncs2nrn_integrate(tstop);
     }
     tstopunset;
-
-    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
-        printf("\nSolver Time : %g\n", nrn_wtime() - time);
-    }
 }
 
 double set_mindelay(double maxdelay) {
@@ -666,8 +967,7 @@ double set_mindelay(double maxdelay) {
         std::vector<int>& negsrcgid_tid = nrnthreads_netcon_negsrcgid_tid[ith];
         size_t i_tid = 0;
         for (int i = 0; i < nt.n_netcon; ++i) {
-            NetCon* nc = nt.netcons + i;
-            bool chk = false;  // ignore nc.delay_
+            bool chk = false;  // ignore the delay
             int gid = nrnthreads_netcon_srcgid[ith][i];
             int tid = ith;
             if (!negsrcgid_tid.empty() && gid < -1) {
@@ -685,8 +985,8 @@ double set_mindelay(double maxdelay) {
                     chk = false;
                 }
             }
-            if (chk && nc->delay_ < mindelay) {
-                mindelay = nc->delay_;
+            if (chk && nt.netcon_delay[i] < mindelay) {
+                mindelay = nt.netcon_delay[i];
             }
         }
     }
@@ -15,4 +15,11 @@ namespace coreneuron {
 
 extern void nrn_spike_exchange_init(void);
 extern void nrn_spike_exchange(NrnThread* nt);
+/// Time nexchange exchange intervals with Allgather and the compressed and multisend exchange
+/// if they are set up, and keep the fastest
+extern void nrn_spike_exchange_autotune(int nexchange);
+/// Exchange spikes as sorted, delta and varint encoded byte streams
+extern void nrn_spike_varint_compress(bool on);
+/// Print the bytes per spike of the varint compressed exchange on rank 0
+extern void nrn_spike_varint_report();
 }  // namespace coreneuron
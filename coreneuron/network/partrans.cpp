@@ -6,6 +6,11 @@
 # =============================================================================
 */
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 #include "coreneuron/nrnconf.h"
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
@@ -32,65 +37,115 @@ int* nrn_partrans::insrcdspl_;
 int* nrn_partrans::outsrccnt_;
 int* nrn_partrans::outsrcdspl_;
 
-void nrnmpi_v_transfer() {
-    // copy source values to outsrc_buf_ and mpi transfer to insrc_buf
+// true while a non-blocking transfer of outsrc_buf_ to insrc_buf_ is in flight
+static std::atomic<bool> transfer_pending_;
+static std::mutex transfer_mutex_;
+static std::condition_variable transfer_done_;
+// the thread that started the transfer, the only one that may complete it
+static std::thread::id transfer_master_;
+
+static bool transfer_compute_gpu() {
+    for (int tid = 0; tid < nrn_nthread; ++tid) {
+        if (nrn_threads[tid].compute_gpu) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void insrc_buf_to_device() {
+    // insrc_buf_ will get copied to targets via nrnthread_v_transfer
+    int n_insrc_buf = insrcdspl_[nrnmpi_numprocs];
+    bool compute_gpu = transfer_compute_gpu();
+    static_cast<void>(n_insrc_buf);
+    static_cast<void>(compute_gpu);
+    nrn_pragma_acc(update device(insrc_buf_ [0:n_insrc_buf]) if (compute_gpu))
+    nrn_pragma_omp(target update to(insrc_buf_ [0:n_insrc_buf]) if (compute_gpu))
+}
+
+static void v_transfer_wait() {
+#if NRNMPI
+    if (use_gap_neighbor_) {
+        nrnmpi_gap_neighbor_wait();
+    } else {
+        nrnmpi_dbl_ialltoallv_wait();
+    }
+#endif
+    insrc_buf_to_device();
+    {
+        std::lock_guard<std::mutex> lock(transfer_mutex_);
+        transfer_pending_ = false;
+    }
+    transfer_done_.notify_all();
+}
+
+void nrnthread_v_gather(NrnThread* nt) {
+    // copy source values of this thread to outsrc_buf_. The outsrc_buf_
+    // locations of different threads are disjoint, so threads can gather
+    // concurrently.
 
     // note that same source value (usually voltage) may get copied to
     // several locations in outsrc_buf
+    auto& ttd = transfer_thread_data_[nt->id];
+    std::size_t n_outsrc_indices = ttd.outsrc_indices.size();
+    if (n_outsrc_indices == 0) {
+        return;
+    }
+    double* src_data = nt->_data;
+    int* src_indices = ttd.src_indices.data();
 
-    // gather the source values. can be done in parallel
-    for (int tid = 0; tid < nrn_nthread; ++tid) {
-        auto& ttd = transfer_thread_data_[tid];
-        auto* nt = &nrn_threads[tid];
-        int n = int(ttd.outsrc_indices.size());
-        if (n == 0) {
-            continue;
-        }
-        double* src_data = nt->_data;
-        int* src_indices = ttd.src_indices.data();
-
-        // gather sources on gpu and copy to cpu, cpu scatters to outsrc_buf
-        double* src_gather = ttd.src_gather.data();
-        size_t n_src_gather = ttd.src_gather.size();
-
-        nrn_pragma_acc(parallel loop present(src_indices [0:n_src_gather],
-                                             src_data [0:nt->_ndata],
-                                             src_gather [0:n_src_gather]) if (nt->compute_gpu)
-                           async(nt->stream_id))
-        nrn_pragma_omp(target teams distribute parallel for simd if(nt->compute_gpu))
-        for (std::size_t i = 0; i < n_src_gather; ++i) {
-            src_gather[i] = src_data[src_indices[i]];
-        }
-        nrn_pragma_acc(update host(src_gather [0:n_src_gather]) if (nt->compute_gpu)
-                           async(nt->stream_id))
-        nrn_pragma_omp(target update from(src_gather [0:n_src_gather]) if (nt->compute_gpu))
+    // gather sources on gpu and copy to cpu, cpu scatters to outsrc_buf
+    double* src_gather = ttd.src_gather.data();
+    size_t n_src_gather = ttd.src_gather.size();
+
+    nrn_pragma_acc(parallel loop present(src_indices [0:n_src_gather],
+                                         src_data [0:nt->_ndata],
+                                         src_gather [0:n_src_gather]) if (nt->compute_gpu)
+                       async(nt->stream_id))
+    nrn_pragma_omp(target teams distribute parallel for simd if(nt->compute_gpu))
+    for (std::size_t i = 0; i < n_src_gather; ++i) {
+        src_gather[i] = src_data[src_indices[i]];
+    }
+    nrn_pragma_acc(update host(src_gather [0:n_src_gather]) if (nt->compute_gpu)
+                       async(nt->stream_id))
+    nrn_pragma_omp(target update from(src_gather [0:n_src_gather]) if (nt->compute_gpu))
+    if (nt->compute_gpu) {
+        nrn_pragma_acc(wait(nt->stream_id))
     }
 
-    // copy gathered source values to outsrc_buf_
-    bool compute_gpu = false;
-    for (int tid = 0; tid < nrn_nthread; ++tid) {
-        if (nrn_threads[tid].compute_gpu) {
-            compute_gpu = true;
-            nrn_pragma_acc(wait(nrn_threads[tid].stream_id))
-        }
-        TransferThreadData& ttd = transfer_thread_data_[tid];
-        size_t n_outsrc_indices = ttd.outsrc_indices.size();
-        int* outsrc_indices = ttd.outsrc_indices.data();
-        double* src_gather = ttd.src_gather.data();
-        int* src_gather_indices = ttd.gather2outsrc_indices.data();
-        for (size_t i = 0; i < n_outsrc_indices; ++i) {
-            outsrc_buf_[outsrc_indices[i]] = src_gather[src_gather_indices[i]];
-        }
+    int* outsrc_indices = ttd.outsrc_indices.data();
+    int* src_gather_indices = ttd.gather2outsrc_indices.data();
+    for (size_t i = 0; i < n_outsrc_indices; ++i) {
+        outsrc_buf_[outsrc_indices[i]] = src_gather[src_gather_indices[i]];
     }
-    static_cast<void>(compute_gpu);
+}
 
-    // transfer
+void nrnmpi_v_transfer_start() {
+    // mpi transfer outsrc_buf_, filled by nrnthread_v_gather, to insrc_buf_
     int n_insrc_buf = insrcdspl_[nrnmpi_numprocs];
 #if NRNMPI
     if (corenrn_param.mpi_enable) {  // otherwise insrc_buf_ == outsrc_buf_
-        nrnmpi_barrier();
-        nrnmpi_dbl_alltoallv(
-            outsrc_buf_, outsrccnt_, outsrcdspl_, insrc_buf_, insrccnt_, insrcdspl_);
+        // The alltoallv synchronises the ranks that exchange voltages, no barrier needed.
+        if (use_gap_neighbor_) {
+            nrnmpi_gap_neighbor_start();
+            transfer_pending_ = true;
+        } else if (corenrn_param.gap_nonblocking) {
+            nrnmpi_dbl_ialltoallv(
+                outsrc_buf_, outsrccnt_, outsrcdspl_, insrc_buf_, insrccnt_, insrcdspl_);
+            transfer_pending_ = true;
+        } else {
+            nrnmpi_dbl_alltoallv(
+                outsrc_buf_, outsrccnt_, outsrcdspl_, insrc_buf_, insrccnt_, insrcdspl_);
+        }
+        if (transfer_pending_) {
+            // completed in nonvint, or right away when blocking
+            if (corenrn_param.gap_nonblocking) {
+                transfer_master_ = std::this_thread::get_id();
+            } else {
+                v_transfer_wait();
+            }
+            return;
+        }
     } else
 #endif
     {  // Use the multiprocess code even for one process to aid debugging
@@ -99,15 +154,37 @@ void nrnmpi_v_transfer() {
             insrc_buf_[i] = outsrc_buf_[i];
         }
     }
+    insrc_buf_to_device();
+}
 
-    // insrc_buf_ will get copied to targets via nrnthread_v_transfer
-    nrn_pragma_acc(update device(insrc_buf_ [0:n_insrc_buf]) if (compute_gpu))
-    nrn_pragma_omp(target update to(insrc_buf_ [0:n_insrc_buf]) if (compute_gpu))
+void nrnmpi_v_transfer() {
+    // gather the source values in parallel and transfer, always blocking
+    nrn_multithread_job(nrnthread_v_gather);
+    nrnmpi_v_transfer_start();
+    if (transfer_pending_) {
+        v_transfer_wait();
+    }
+}
+
+void nrnthread_v_transfer_wait(NrnThread*) {
+    if (transfer_pending_) {
+        // With MPI_THREAD_FUNNELED only the master thread, which started the
+        // transfer, may complete the request. The others block until it has.
+        // The master runs the job of NrnThread 0, so it gets here whichever
+        // NrnThreads the other threads run and in whatever order.
+        if (std::this_thread::get_id() == transfer_master_) {
+            v_transfer_wait();
+        } else {
+            std::unique_lock<std::mutex> lock(transfer_mutex_);
+            transfer_done_.wait(lock, [] { return !transfer_pending_; });
+        }
+    }
 }
 
 void nrnthread_v_transfer(NrnThread* _nt) {
     // Copy insrc_buf_ values to the target locations. (An insrc_buf_ value
     // may be copied to several target locations.
+    nrnthread_v_transfer_wait(_nt);
     TransferThreadData& ttd = transfer_thread_data_[_nt->id];
     size_t ntar = ttd.tar_indices.size();
     int* tar_indices = ttd.tar_indices.data();
@@ -24,7 +24,15 @@ namespace coreneuron {
 struct Memb_list;
 
 extern bool nrn_have_gaps;
+/// Gather the sources of all threads and transfer them (blocking)
 extern void nrnmpi_v_transfer();
+/// Gather the sources of one thread into the send buffer
+extern void nrnthread_v_gather(NrnThread*);
+/// Transfer the gathered sources, non-blocking with --gap-nonblocking
+extern void nrnmpi_v_transfer_start();
+/// Complete a pending non-blocking transfer, must be called by every thread
+extern void nrnthread_v_transfer_wait(NrnThread*);
+/// Copy the received sources to the targets, completing a pending transfer first
 extern void nrnthread_v_transfer(NrnThread*);
 
 namespace nrn_partrans {
@@ -59,17 +67,21 @@ namespace nrn_partrans {
  **/
 
 /*
- * In partrans.cpp: nrnmpi_v_transfer
- *   Copy NrnThead.data to outsrc_buf_ for all threads via
+ * In partrans.cpp: nrnthread_v_gather, called by each thread after update()
+ *   Copy NrnThead.data to outsrc_buf_ for the thread via
  *     gpu: gather src_gather[i] = NrnThread._data[src_indices[i]];
  *     gpu to host src_gather
  *     cpu: outsrc_buf_[outsrc_indices[i]] = src_gather[gather2outsrc_indices[i]];
  *
- *   MPI_Allgatherv outsrc_buf_ to insrc_buf_
+ * In partrans.cpp: nrnmpi_v_transfer_start
+ *   neighbour alltoallv of outsrc_buf_ to insrc_buf_ on the graph
+ *   communicator built by gap_mpi_setup. With --gap-nonblocking the transfer
+ *   overlaps with the rest of the step until nrnthread_v_transfer in nonvint
  *
  *   host to gpu insrc_buf_
  *
  * In partrans.cpp: nrnthread_v_transfer
+ *   complete a pending MPI_Ialltoallv
  *   insrc_buf_ to NrnThread._data via
  *   NrnThread.data[tar_indices[i]] = insrc_buf_[insrc_indices[i]];
  *     where tar_indices depends on layout, type, etc.
@@ -104,6 +116,8 @@ namespace coreneuron {
 namespace nrn_partrans {
 
 extern SetupTransferInfo* setup_info_; /* array for threads exists only during setup*/
+/// transfer with the neighbour collective of the gap junction graph communicator
+extern bool use_gap_neighbor_;
 
 extern void gap_mpi_setup(int ngroup);
 extern void gap_data_indices_setup(NrnThread* nt);
@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "coreneuron/coreneuron.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
 #include "coreneuron/nrnconf.h"
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
@@ -21,6 +22,16 @@ namespace coreneuron {
 using namespace coreneuron::nrn_partrans;
 
 SetupTransferInfo* nrn_partrans::setup_info_;
+bool nrn_partrans::use_gap_neighbor_;
+
+// source and destination ranks of the gap junction graph communicator and the
+// compacted counts and displacements. They must outlive the persistent request.
+static std::vector<int> gap_srcs_;
+static std::vector<int> gap_rcnt_;
+static std::vector<int> gap_rdispl_;
+static std::vector<int> gap_dests_;
+static std::vector<int> gap_scnt_;
+static std::vector<int> gap_sdispl_;
 
 class SidInfo {
   public:
@@ -143,6 +154,35 @@ void nrn_partrans::gap_mpi_setup(int ngroup) {
     insrc_buf_ = new double[insrcdspl_[nhost]];
     outsrc_buf_ = new double[outsrcdspl_[nhost]];
 
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        // only the ranks we exchange voltages with are neighbours of the graph
+        for (int i = 0; i < nhost; ++i) {
+            if (insrccnt_[i] > 0) {
+                gap_srcs_.push_back(i);
+                gap_rcnt_.push_back(insrccnt_[i]);
+                gap_rdispl_.push_back(insrcdspl_[i]);
+            }
+            if (outsrccnt_[i] > 0) {
+                gap_dests_.push_back(i);
+                gap_scnt_.push_back(outsrccnt_[i]);
+                gap_sdispl_.push_back(outsrcdspl_[i]);
+            }
+        }
+        nrnmpi_gap_neighbor_init(gap_srcs_.size(),
+                                 gap_srcs_.data(),
+                                 gap_rcnt_.data(),
+                                 gap_rdispl_.data(),
+                                 insrc_buf_,
+                                 gap_dests_.size(),
+                                 gap_dests_.data(),
+                                 gap_scnt_.data(),
+                                 gap_sdispl_.data(),
+                                 outsrc_buf_);
+        use_gap_neighbor_ = true;
+    }
+#endif
+
     // for i: src_gather[i] = NrnThread._data[src_indices[i]]
     // for j: outsrc_buf[outsrc_indices[j]] = src_gather[gather2outsrc_indices[j]]
     // src_indices point into NrnThread._data
@@ -269,6 +309,18 @@ void nrn_partrans::gap_data_indices_setup(NrnThread* n) {
 }
 
 void nrn_partrans::gap_cleanup() {
+#if NRNMPI
+    if (use_gap_neighbor_) {
+        nrnmpi_gap_neighbor_free();
+        use_gap_neighbor_ = false;
+        gap_srcs_.clear();
+        gap_rcnt_.clear();
+        gap_rdispl_.clear();
+        gap_dests_.clear();
+        gap_scnt_.clear();
+        gap_sdispl_.clear();
+    }
+#endif
     if (transfer_thread_data_) {
         delete[] transfer_thread_data_;
         transfer_thread_data_ = nullptr;
@@ -0,0 +1,131 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "coreneuron/mpi/nrnmpi.h"
+
+namespace coreneuron {
+
+/*
+Variable length spike encoding used by the varint compressed spike exchange.
+The spikes of an interval are sorted by (gid, spiketime) and each spike is
+written as two LEB128 varints:
+    the gid difference to the previous spike (the first one to gid 0),
+    the spike time in units of dt, zigzag encoded, relative to the previous
+    spike of the same gid or else to the time of the last exchange.
+Typical spikes therefore take 2 to 4 bytes instead of the 16 of NRNMPI_Spike,
+and, unlike the fixed size compression, there is no limit of 255 dt on the
+spike time offset and hence on the usable min delay.
+*/
+namespace spike_varint {
+
+/// Maximum number of bytes of one varint and of one spike
+constexpr int max_varint_bytes = 5;
+constexpr int max_spike_bytes = 2 * max_varint_bytes;
+/// Minimum number of bytes of one spike, i.e. an upper bound on the spikes of a buffer
+constexpr int min_spike_bytes = 2;
+
+inline unsigned char* put(unsigned char* p, std::uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = static_cast<unsigned char>(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = static_cast<unsigned char>(v);
+    return p;
+}
+
+inline const unsigned char* get(const unsigned char* p, std::uint32_t& v) {
+    v = 0;
+    for (int shift = 0;; shift += 7) {
+        unsigned char c = *p++;
+        v |= static_cast<std::uint32_t>(c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            return p;
+        }
+    }
+}
+
+inline std::uint32_t zigzag(std::int32_t v) {
+    return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31);
+}
+
+inline std::int32_t unzigzag(std::uint32_t v) {
+    return static_cast<std::int32_t>(v >> 1) ^ -static_cast<std::int32_t>(v & 1);
+}
+
+/**
+ * Sort the spikes and append their encoding to buf
+ *
+ * Spike times are rounded to a multiple of dt after t0.
+ *
+ * @param spikes spikes to encode, reordered by (gid, spiketime)
+ * @param rdt 1 / dt
+ * @return number of bytes appended
+ */
+inline std::size_t encode(NRNMPI_Spike* spikes,
+                          int n,
+                          double t0,
+                          double rdt,
+                          std::vector<unsigned char>& buf) {
+    std::sort(spikes, spikes + n, [](const NRNMPI_Spike& a, const NRNMPI_Spike& b) {
+        return a.gid < b.gid || (a.gid == b.gid && a.spiketime < b.spiketime);
+    });
+    std::size_t start = buf.size();
+    buf.resize(start + std::size_t(n) * max_spike_bytes);
+    unsigned char* p = buf.data() + start;
+    int gid = 0;
+    std::int32_t step = 0;
+    for (int i = 0; i < n; ++i) {
+        auto istep = static_cast<std::int32_t>(std::floor((spikes[i].spiketime - t0) * rdt + .5));
+        p = put(p, static_cast<std::uint32_t>(spikes[i].gid - gid));
+        p = put(p, zigzag(i && spikes[i].gid == gid ? istep - step : istep));
+        gid = spikes[i].gid;
+        step = istep;
+    }
+    std::size_t nbytes = p - (buf.data() + start);
+    buf.resize(start + nbytes);
+    return nbytes;
+}
+
+/**
+ * Decode the spikes of nbytes of buf into out
+ *
+ * out must have room for nbytes / min_spike_bytes spikes.
+ *
+ * @return number of spikes decoded
+ */
+inline int decode(const unsigned char* buf,
+                  std::size_t nbytes,
+                  double t0,
+                  double dt,
+                  NRNMPI_Spike* out) {
+    const unsigned char* end = buf + nbytes;
+    int n = 0;
+    std::uint32_t gid = 0;
+    std::int32_t step = 0;
+    while (buf < end) {
+        std::uint32_t dgid, v;
+        buf = get(buf, dgid);
+        buf = get(buf, v);
+        step = (n && dgid == 0) ? step + unzigzag(v) : unzigzag(v);
+        gid += dgid;
+        out[n].gid = static_cast<int>(gid);
+        out[n].spiketime = t0 + step * dt;
+        ++n;
+    }
+    return n;
+}
+}  // namespace spike_varint
+}  // namespace coreneuron
@@ -142,6 +142,10 @@ class TQueue {
     }
 
     inline TQItem* atomic_dq(double til);
+    /// Call f for the items that atomic_dq would return, in time order,
+    /// without changing the queue
+    template <typename F>
+    inline void for_each_ordered(F f);
     inline void remove(TQItem*);
     inline void move(TQItem*, double tnew);
     int nshift_;
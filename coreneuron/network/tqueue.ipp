@@ -266,5 +266,33 @@ inline TQItem* TQueue<pq_que>::atomic_dq(double tt) {
     }
     return q;
 }
+
+template <container C>
+template <typename F>
+void TQueue<C>::for_each_ordered(F f) {
+    if (least_) {
+        f(least_);
+    }
+    // in order walk of the splay tree
+    std::vector<TQItem*> stack;
+    for (TQItem* q = sptree_->root; q || !stack.empty();) {
+        if (q) {
+            stack.push_back(q);
+            q = q->left_;
+        } else {
+            q = stack.back();
+            stack.pop_back();
+            f(q);
+            q = q->right_;
+        }
+    }
+    // items moved by move() are left in the priority queue with a negative time
+    auto pq = pq_que_;
+    for (; !pq.empty(); pq.pop()) {
+        if (pq.top().second->t_ >= 0.) {
+            f(pq.top().second);
+        }
+    }
+}
 }  // namespace coreneuron
 #endif
@@ -11,6 +11,7 @@
 #include <vector>
 #include <map>
 #include "coreneuron/network/netcon.hpp"
+#include "coreneuron/utils/flat_gid_map.hpp"
 namespace coreneuron {
 
 /// Mechanism type to be used from stdindex2ptr and nrn_dblpntr2nrncore (in Neuron)
@@ -24,6 +25,8 @@ extern std::vector<std::map<int, PreSyn*>> neg_gid2out;
 /// Maps for ouput and input presyns
 extern std::map<int, PreSyn*> gid2out;
 extern std::map<int, InputPreSyn*> gid2in;
+/// Immutable copy of gid2in for the spike receive loops, built in determine_inputpresyn
+extern FlatGidMap<InputPreSyn> gid2in_index;
 
 /// InputPreSyn.nc_index_ to + InputPreSyn.nc_cnt_ give the NetCon*
 extern std::vector<NetCon*> netcon_in_presyn_order_;
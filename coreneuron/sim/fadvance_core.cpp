@@ -7,6 +7,9 @@
 */
 
 #include <functional>
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
 
 #include "coreneuron/coreneuron.hpp"
 #include "coreneuron/nrnconf.h"
@@ -14,15 +17,19 @@
 #include "coreneuron/sim/multicore.hpp"
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/sim/fast_imem.hpp"
+#include "coreneuron/sim/thread_balance.hpp"
 #include "coreneuron/gpu/nrn_acc_manager.hpp"
 #include "coreneuron/io/reports/nrnreport.hpp"
 #include "coreneuron/network/netcvode.hpp"
 #include "coreneuron/network/netpar.hpp"
 #include "coreneuron/network/partrans.hpp"
 #include "coreneuron/utils/nrnoc_aux.hpp"
+#include "coreneuron/utils/utils.hpp"
 #include "coreneuron/utils/progressbar/progressbar.hpp"
 #include "coreneuron/utils/profile/profiler_interface.h"
 #include "coreneuron/io/nrn2core_direct.h"
+#include "coreneuron/io/cost_profile.hpp"
+#include "coreneuron/io/group_cost.hpp"
 
 namespace coreneuron {
 static void* nrn_fixed_step_thread(NrnThread*);
@@ -100,15 +107,20 @@ void nrn_fixed_step_minimal() { /* not so minimal anymore with gap junctions */
     if (nrn_have_gaps) {
         {
             Instrumentor::phase p_gap("gap-v-transfer");
-            nrnmpi_v_transfer();
+            nrnmpi_v_transfer_start();
         }
         nrn_multithread_job(nrn_fixed_step_lastpart);
     }
-#if NRNMPI
+    // the end of a minimum delay interval
     if (nrn_threads[0]._stop_stepping) {
+#if NRNMPI
         nrn_spike_exchange(nrn_threads);
-    }
 #endif
+        for (int i = 0; i < nrn_nthread; ++i) {
+            nrn_threads[i]._stop_stepping = 0;
+        }
+        nrn_thread_balance_check();
+    }
 
 #if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
     {
@@ -161,6 +173,7 @@ void nrn_fixed_step_group_minimal(int total_sim_steps) {
 #if NRNMPI
         nrn_spike_exchange(nrn_threads);
 #endif
+        nrn_thread_balance_check();
 
 #if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
         {
@@ -177,24 +190,117 @@ void nrn_fixed_step_group_minimal(int total_sim_steps) {
     t = nrn_threads[0]._t;
 }
 
+/* Gap junction models need the voltage transfer between update() and nonvint
+of every step, so nrn_fixed_step_group_minimal is not possible and single
+steps leave the parallel region twice per step. Here the threads stay in one
+parallel region for a whole minimum delay interval, each one stepping its
+NrnThread (or every num_threads'th one if there are fewer OpenMP threads), and
+the master thread, which MPI_THREAD_FUNNELED requires for MPI calls, starts
+the voltage transfer between barriers. The spike exchange, which runs jobs on
+the threads itself, the thread balancing and the report flushing are done
+outside of the parallel region, as in nrn_fixed_step_group_minimal.
+*/
+void nrn_fixed_step_group_gap(int total_sim_steps) {
+    dt2thread(dt);
+    nrn_thread_table_check();
+    ProgressBar progress_bar(total_sim_steps);
+    int step_begin = 0;
+    while (step_begin < total_sim_steps) {
+        int step_end = total_sim_steps;
+        bool stop = false;
+        // clang-format off
+
+        #pragma omp parallel num_threads(nrn_nthread) shared(step_end, stop)
+        // clang-format on
+        {
+            int ith = 0;
+            int nth = 1;
+#if defined(_OPENMP)
+            ith = omp_get_thread_num();
+            nth = omp_get_num_threads();
+#endif
+            for (int step = step_begin; step < total_sim_steps; ++step) {
+                {
+                    Instrumentor::phase p_timestep("timestep");
+                    for (int i = ith; i < nrn_nthread; i += nth) {
+                        nrn_fixed_step_thread(nrn_threads + i);
+                    }
+                }
+                // clang-format off
+                #pragma omp barrier
+                #pragma omp master
+                // clang-format on
+                {
+                    Instrumentor::phase p_gap("gap-v-transfer");
+                    nrnmpi_v_transfer_start();
+                }
+                // clang-format off
+                #pragma omp barrier
+                // clang-format on
+                for (int i = ith; i < nrn_nthread; i += nth) {
+                    nrn_fixed_step_lastpart(nrn_threads + i);
+                }
+                // clang-format off
+                #pragma omp barrier
+                #pragma omp master
+                // clang-format on
+                {
+                    // the threads write their _stop_stepping in the next step
+                    stop = nrn_threads[0]._stop_stepping;
+                    if (stop) {
+                        step_end = step + 1;
+                    }
+                }
+                // clang-format off
+                #pragma omp barrier
+                // clang-format on
+                if (stop) {
+                    break;
+                }
+            }
+        }
+#if NRNMPI
+        if (nrn_threads[0]._stop_stepping) {
+            nrn_spike_exchange(nrn_threads);
+        }
+#endif
+        for (int i = 0; i < nrn_nthread; ++i) {
+            nrn_threads[i]._stop_stepping = 0;
+        }
+        nrn_thread_balance_check();
+
+#if defined(ENABLE_BIN_REPORTS) || defined(ENABLE_SONATA_REPORTS)
+        {
+            Instrumentor::phase p("flush_reports");
+            nrn_flush_reports(nrn_threads[0]._t);
+        }
+#endif
+        if (stoprun) {
+            break;
+        }
+        step_begin = step_end;
+        progress_bar.update(step_end, nrn_threads[0]._t);
+    }
+    t = nrn_threads[0]._t;
+}
+
 static void nrn_fixed_step_group_thread(NrnThread* nth,
                                         int step_group_max,
                                         int step_group_begin,
                                         int& step_group_end) {
     nth->_stop_stepping = 0;
-    for (int i = step_group_begin; i < step_group_max; ++i) {
+    int i = step_group_begin;
+    for (; i < step_group_max; ++i) {
         Instrumentor::phase p_timestep("timestep");
         nrn_fixed_step_thread(nth);
         if (nth->_stop_stepping) {
-            if (nth->id == 0) {
-                step_group_end = i + 1;
-            }
             nth->_stop_stepping = 0;
-            return;
+            ++i;
+            break;
         }
     }
     if (nth->id == 0) {
-        step_group_end = step_group_max;
+        step_group_end = i;
     }
 }
 
@@ -244,7 +350,11 @@ void nonvint(NrnThread* _nt) {
             ss += nrn_get_mechname(tml->index);
             {
                 Instrumentor::phase p(ss.c_str());
+                double wt = nrn_cost_calibrate_enabled ? nrn_wtime() : 0.;
                 (*s)(_nt, tml->ml, tml->index);
+                if (nrn_cost_calibrate_enabled) {
+                    nrn_cost_calibrate_mech_time(_nt, tml->index, nrn_wtime() - wt);
+                }
             }
 #ifdef DEBUG
             if (errno) {
@@ -330,12 +440,17 @@ void nrncore2nrn_send_values(NrnThread* nth) {
 }
 
 static void* nrn_fixed_step_thread(NrnThread* nth) {
+    // compute time for the thread balancing and the cost profile
+    double wt = nrn_wtime();
     /* check thresholds and deliver all (including binqueue)
        events up to t+dt/2 */
     {
         Instrumentor::phase p("deliver-events");
         deliver_net_events(nth);
     }
+    if (nrn_cost_profile_enabled) {
+        nrn_cost_profile_deliver_time(nth, nrn_wtime() - wt);
+    }
 
     nth->_t += .5 * nth->_dt;
 
@@ -367,13 +482,19 @@ static void* nrn_fixed_step_thread(NrnThread* nth) {
             update(nth);
         }
     }
-    if (!nrn_have_gaps) {
+    if (nrn_have_gaps) {
+        Instrumentor::phase p("gap-v-gather");
+        nrnthread_v_gather(nth);
+    } else {
         nrn_fixed_step_lastpart(nth);
     }
+    nth->_ctime += nrn_wtime() - wt;
     return nullptr;
 }
 
 void* nrn_fixed_step_lastpart(NrnThread* nth) {
+    // with gaps a job of its own, otherwise timed by nrn_fixed_step_thread
+    double wt = nrn_have_gaps ? nrn_wtime() : 0.;
     nth->_t += .5 * nth->_dt;
 
     if (nth->ncell) {
@@ -387,6 +508,10 @@ void* nrn_fixed_step_lastpart(NrnThread* nth) {
         nrn_ba(nth, BEFORE_STEP);
         nrncore2nrn_send_values(nth);  // consistent with NEURON. (after BEFORE_STEP)
     } else {
+        if (nrn_have_gaps) {
+            // nonvint is skipped, but the master may have to complete the transfer
+            nrnthread_v_transfer_wait(nth);
+        }
         nrncore2nrn_send_values(nth);
     }
 
@@ -395,6 +520,9 @@ void* nrn_fixed_step_lastpart(NrnThread* nth) {
         nrn_deliver_events(nth); /* up to but not past texit */
     }
 
+    if (nrn_have_gaps) {
+        nth->_ctime += nrn_wtime() - wt;
+    }
     return nullptr;
 }
 }  // namespace coreneuron
@@ -123,6 +123,7 @@ void nrn_threads_create(int n) {
 }
 
 void nrn_threads_free() {
+    nrn_thread_team_stop();
     if (nrn_nthread) {
         delete[] nrn_threads;
         nrn_threads = nullptr;
@@ -13,7 +13,10 @@
 #include "coreneuron/utils/memory.h"
 #include "coreneuron/mpi/nrnmpi.h"
 #include "coreneuron/mpi/core/nrnmpi.hpp"
+#include "coreneuron/network/netcon.hpp"
 #include "coreneuron/io/reports/nrnreport.hpp"
+#include "coreneuron/sim/thread_team.hpp"
+#include <cstdint>
 #include <vector>
 #include <memory>
 
@@ -85,6 +88,12 @@ struct NrnThread: public MemoryManaged {
     int** pnt2presyn_ix = nullptr;  // eliminates Point_process._presyn used only by net_event
                                     // sender.
     NetCon* netcons = nullptr;
+    double* netcon_delay = nullptr;      // n_netcon, the data of the netcons handles
+    int* netcon_target = nullptr;        // index into pntprocs, -1 if none
+    int* netcon_weight_index = nullptr;  // index into weights
+    // replace the two above when they fit, see index_compression.hpp
+    std::uint16_t* netcon_target16 = nullptr;
+    std::uint16_t* netcon_weight_index16 = nullptr;
     double* weights = nullptr;  // size n_weight. NetCon.weight_ points into this array.
 
     int n_pntproc = 0;
@@ -159,6 +168,12 @@ extern int nrn_nthread;
 extern NrnThread* nrn_threads;
 template <typename F, typename... Args>
 void nrn_multithread_job(F&& job, Args&&... args) {
+    if (nrn_thread_team_active()) {
+        auto work = [&](NrnThread* nt) { job(nt, args...); };
+        nrn_thread_team_run(
+            [](void* ctx, NrnThread* nt) { (*static_cast<decltype(work)*>(ctx))(nt); }, &work);
+        return;
+    }
     int i;
     // clang-format off
 
@@ -187,6 +202,7 @@ extern void nrncore2nrn_send_init();
 extern void* setup_tree_matrix_minimal(NrnThread*);
 extern void nrncore2nrn_send_values(NrnThread*);
 extern void nrn_fixed_step_group_minimal(int total_sim_steps);
+extern void nrn_fixed_step_group_gap(int total_sim_steps);
 extern void nrn_fixed_single_steps_minimal(int total_sim_steps, double tstop);
 extern void nrn_fixed_step_minimal(void);
 extern void nrn_finitialize(int setv, double v);
@@ -202,4 +218,39 @@ constexpr int at_time(NrnThread* nt, double te) {
     }
     return 0;
 }
+
+/// Target of NetCon i of nt as index into pntprocs, -1 if none
+inline int nrn_netcon_target(const NrnThread* nt, int i) {
+    if (nt->netcon_target16) {
+        int itarget = nt->netcon_target16[i];
+        return itarget == UINT16_MAX ? -1 : itarget;
+    }
+    return nt->netcon_target[i];
+}
+
+inline int nrn_netcon_weight_index(const NrnThread* nt, int i) {
+    return nt->netcon_weight_index16 ? nt->netcon_weight_index16[i] : nt->netcon_weight_index[i];
+}
+
+inline NrnThread* NetCon::thread() const {
+    return nrn_threads + tid_;
+}
+
+inline bool NetCon::active() const {
+    return nrn_netcon_target(thread(), index_) >= 0;
+}
+
+inline double NetCon::delay() const {
+    return thread()->netcon_delay[index_];
+}
+
+inline Point_process* NetCon::target() const {
+    NrnThread* nt = thread();
+    int i = nrn_netcon_target(nt, index_);
+    return i >= 0 ? nt->pntprocs + i : nullptr;
+}
+
+inline int NetCon::weight_index() const {
+    return nrn_netcon_weight_index(thread(), index_);
+}
 }  // namespace coreneuron
@@ -0,0 +1,166 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+#include "coreneuron/sim/thread_balance.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/sim/thread_placement.hpp"
+
+namespace coreneuron {
+
+namespace {
+int interval_;
+double threshold_;
+int count_;
+int nmember_;
+std::vector<int> member_of_;
+std::vector<double> ctime_last_;
+// NUMA node of every member and of the data of every NrnThread
+std::vector<int> member_node_;
+std::vector<int> thread_node_;
+
+int ncheck_;
+int nassign_;
+double first_imbalance_;
+double last_imbalance_;
+}  // namespace
+
+double nrn_thread_imbalance(const std::vector<double>& cost,
+                            const std::vector<int>& member_of,
+                            int nmember) {
+    std::vector<double> load(nmember, 0.);
+    for (std::size_t i = 0; i < cost.size(); ++i) {
+        load[member_of[i]] += cost[i];
+    }
+    double sum = std::accumulate(load.begin(), load.end(), 0.);
+    double max = *std::max_element(load.begin(), load.end());
+    return sum > 0. ? max * nmember / sum - 1. : 0.;
+}
+
+std::vector<int> nrn_thread_lpt_assign(const std::vector<double>& cost, int nmember) {
+    return nrn_thread_lpt_assign(cost,
+                                 std::vector<int>(nmember, 0),
+                                 std::vector<int>(cost.size(), 0));
+}
+
+std::vector<int> nrn_thread_lpt_assign(const std::vector<double>& cost,
+                                       const std::vector<int>& member_domain,
+                                       const std::vector<int>& thread_domain) {
+    int nmember = member_domain.size();
+    std::vector<int> member_of(cost.size(), 0);
+    std::vector<double> load(nmember, 0.);
+    // NrnThread 0 stays with the master, which does the MPI calls (MPI_THREAD_FUNNELED)
+    load[0] = cost[0];
+    std::vector<int> order(cost.size() - 1);
+    std::iota(order.begin(), order.end(), 1);
+    std::stable_sort(order.begin(), order.end(), [&cost](int a, int b) {
+        return cost[a] > cost[b];
+    });
+    for (int i: order) {
+        int best = -1;
+        for (int m = 0; m < nmember; ++m) {
+            if (member_domain[m] == thread_domain[i] && (best < 0 || load[m] < load[best])) {
+                best = m;
+            }
+        }
+        if (best < 0) {
+            best = std::min_element(load.begin(), load.end()) - load.begin();
+        }
+        member_of[i] = best;
+        load[best] += cost[i];
+    }
+    return member_of;
+}
+
+bool nrn_thread_balance_init(int interval, double threshold) {
+    interval_ = 0;
+    nmember_ = nrn_thread_team_size();
+    if (interval <= 0 || nmember_ < 2 || nrn_nthread <= nmember_) {
+        return false;
+    }
+    interval_ = interval;
+    threshold_ = threshold;
+    count_ = 0;
+    ncheck_ = 0;
+    nassign_ = 0;
+    member_of_ = nrn_thread_team_assignment();
+    // the data was first touched by the member that populated the NrnThread, which is the
+    // member it runs on until the first reassignment. Unpinned members may run on any CPU,
+    // so their NUMA node says nothing and they all count as one node.
+    thread_node_.assign(nrn_nthread, 0);
+    member_node_.assign(nmember_, 0);
+    if (corenrn_param.pin_threads) {
+        nrn_multithread_job(
+            [](NrnThread* nt) { thread_node_[nt->id] = nrn_current_numa_node(); });
+        for (int i = 0; i < nrn_nthread; ++i) {
+            member_node_[member_of_[i]] = thread_node_[i];
+        }
+    }
+    ctime_last_.resize(nrn_nthread);
+    for (int i = 0; i < nrn_nthread; ++i) {
+        ctime_last_[i] = nrn_threads[i]._ctime;
+    }
+    return true;
+}
+
+void nrn_thread_balance_check() {
+    if (interval_ == 0 || ++count_ < interval_) {
+        return;
+    }
+    count_ = 0;
+    // cost of every NrnThread since the last check
+    std::vector<double> cost(nrn_nthread);
+    for (int i = 0; i < nrn_nthread; ++i) {
+        cost[i] = nrn_threads[i]._ctime - ctime_last_[i];
+        ctime_last_[i] = nrn_threads[i]._ctime;
+    }
+    double imbalance = nrn_thread_imbalance(cost, member_of_, nmember_);
+    if (ncheck_++ == 0) {
+        first_imbalance_ = imbalance;
+    }
+    last_imbalance_ = imbalance;
+    if (imbalance <= threshold_) {
+        return;
+    }
+    // the measured times are noisy, only move if the gain is clear
+    std::vector<int> member_of = nrn_thread_lpt_assign(cost, member_node_, thread_node_);
+    if (nrn_thread_imbalance(cost, member_of, nmember_) < imbalance - 0.5 * threshold_) {
+        member_of_ = member_of;
+        nrn_thread_team_assign(member_of_);
+        ++nassign_;
+    }
+}
+
+void nrn_thread_balance_report() {
+    if (interval_ == 0) {
+        return;
+    }
+    double first = ncheck_ ? first_imbalance_ : 0.;
+    double last = ncheck_ ? last_imbalance_ : 0.;
+    double nassign = nassign_;
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        first = nrnmpi_dbl_allreduce(first, 2);
+        last = nrnmpi_dbl_allreduce(last, 2);
+        nassign = nrnmpi_dbl_allreduce(nassign, 2);
+    }
+#endif
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Thread load balance: imbalance %.1f%% at first and %.1f%% at last check, "
+               "at most %.0f reassignments per rank\n",
+               100. * first,
+               100. * last,
+               nassign);
+    }
+}
+}  // namespace coreneuron
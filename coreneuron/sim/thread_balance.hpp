@@ -0,0 +1,50 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+namespace coreneuron {
+
+/**
+ * \brief Runtime load balancing of the NrnThreads over the thread team
+ *
+ * nrn_fixed_step_thread accumulates the compute time of every NrnThread in
+ * NrnThread::_ctime. Every interval minimum delay intervals the master
+ * compares the loads of the team members and, if the imbalance max / mean - 1
+ * exceeds the threshold, reassigns the NrnThreads to members with LPT. Whole
+ * NrnThreads (cell groups) move with their data in place, so this needs more
+ * cell groups than threads and never moves NrnThread 0 off the master. The
+ * data of a NrnThread stays where it was first touched, so with
+ * --pin-threads it only moves between members on the NUMA node it was
+ * populated on. The measured times are noisy, so the gain has to be clear
+ * before anything moves.
+ */
+
+/// @param interval minimum delay intervals between checks
+/// @param threshold imbalance above which the NrnThreads are reassigned
+/// @return false if there is nothing to balance, i.e. no team or a group per member
+bool nrn_thread_balance_init(int interval, double threshold);
+/// Called by the master after every minimum delay interval
+void nrn_thread_balance_check();
+/// Print imbalance and number of reassignments on rank 0
+void nrn_thread_balance_report();
+
+/// max / mean - 1 of the member loads when NrnThread i with cost[i] runs on member_of[i]
+double nrn_thread_imbalance(const std::vector<double>& cost,
+                            const std::vector<int>& member_of,
+                            int nmember);
+/// LPT assignment of the NrnThreads to nmember members with NrnThread 0 on member 0
+std::vector<int> nrn_thread_lpt_assign(const std::vector<double>& cost, int nmember);
+/// nrn_thread_lpt_assign where NrnThread i only goes to a member m with
+/// member_domain[m] == thread_domain[i], if there is one
+std::vector<int> nrn_thread_lpt_assign(const std::vector<double>& cost,
+                                       const std::vector<int>& member_domain,
+                                       const std::vector<int>& thread_domain);
+}  // namespace coreneuron
@@ -0,0 +1,126 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "coreneuron/sim/thread_placement.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/sim/multicore.hpp"
+
+namespace coreneuron {
+
+namespace {
+constexpr int nsample = 16;
+
+struct Placement {
+    int node = -1;  // NUMA node of the thread
+    int nlocal = 0;
+    int nsampled = 0;
+};
+
+#if defined(__linux__) && defined(SYS_getcpu) && defined(SYS_move_pages)
+int current_node() {
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) {
+        return -1;
+    }
+    return node;
+}
+
+// move_pages without target nodes only queries the node of every page
+void sample_pages(const void* p, std::size_t nbytes, Placement& pl) {
+    if (!p || nbytes == 0) {
+        return;
+    }
+    auto page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto begin = reinterpret_cast<std::uintptr_t>(p);
+    std::vector<void*> pages;
+    for (int k = 0; k < nsample; ++k) {
+        std::uintptr_t addr = (begin + nbytes / nsample * k) & ~(page - 1);
+        if (pages.empty() || pages.back() != reinterpret_cast<void*>(addr)) {
+            pages.push_back(reinterpret_cast<void*>(addr));
+        }
+    }
+    std::vector<int> status(pages.size(), -1);
+    if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) {
+        return;
+    }
+    for (int s: status) {
+        if (s >= 0) {
+            ++pl.nsampled;
+            pl.nlocal += (s == pl.node);
+        }
+    }
+}
+#else
+int current_node() {
+    return -1;
+}
+
+void sample_pages(const void*, std::size_t, Placement&) {}
+#endif
+}  // namespace
+
+int nrn_current_numa_node() {
+    return current_node();
+}
+
+void nrn_thread_placement_report() {
+    std::vector<Placement> placement(nrn_nthread);
+    nrn_multithread_job([&placement](NrnThread* nt) {
+        auto& pl = placement[nt->id];
+        pl.node = current_node();
+        if (pl.node >= 0) {
+            sample_pages(nt->_data, nt->_ndata * sizeof(double), pl);
+        }
+    });
+
+    long sum[2] = {0, 0};
+    std::set<int> nodes;
+    for (const auto& pl: placement) {
+        sum[0] += pl.nlocal;
+        sum[1] += pl.nsampled;
+        nodes.insert(pl.node);
+    }
+    double nnode = nodes.size();
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        long all[2];
+        nrnmpi_long_allreduce_vec(sum, all, 2, 1);
+        sum[0] = all[0];
+        sum[1] = all[1];
+        nnode = nrnmpi_dbl_allmax(nnode);
+    }
+#endif
+    if (nrnmpi_myid != 0 || corenrn_param.is_quiet() || sum[1] == 0) {
+        return;
+    }
+    printf(" NUMA placement: %.1f%% of the sampled NrnThread data pages are local to the "
+           "thread, threads on up to %.0f nodes per rank\n",
+           100. * sum[0] / sum[1],
+           nnode);
+    if (corenrn_param.verbose >= corenrn_parameters_data::DEBUG_INFO) {
+        for (int i = 0; i < nrn_nthread; ++i) {
+            printf("  NrnThread %d: node %d, %d of %d sampled pages local\n",
+                   i,
+                   placement[i].node,
+                   placement[i].nlocal,
+                   placement[i].nsampled);
+        }
+    }
+}
+}  // namespace coreneuron
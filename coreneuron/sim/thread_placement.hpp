@@ -0,0 +1,26 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+namespace coreneuron {
+
+/**
+ * \brief Report the NUMA placement of the NrnThread data
+ *
+ * Every NrnThread checks, from the thread that integrates it, on which NUMA
+ * node that thread runs and on which nodes a sample of the pages of its _data
+ * (which holds the node and all mechanism arrays) resides. Rank 0 prints the
+ * fraction of local pages over all ranks, and with verbose debug the placement
+ * of its NrnThreads. Linux only, a no-op elsewhere.
+ */
+void nrn_thread_placement_report();
+
+/// NUMA node the calling thread runs on, -1 if unknown
+int nrn_current_numa_node();
+}  // namespace coreneuron
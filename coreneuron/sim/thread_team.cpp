@@ -0,0 +1,289 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <cstdio>
+
+#include "coreneuron/sim/thread_team.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/utils/nrn_assert.h"
+
+#if defined(_OPENMP)
+#include <omp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#endif
+
+namespace coreneuron {
+
+#if defined(_OPENMP)
+namespace {
+// sense reversing barrier, every member keeps its own local sense
+class SenseBarrier {
+  public:
+    void reset(int n) {
+        n_ = n;
+        count_ = 0;
+        sense_ = false;
+    }
+
+    void wait(bool& local_sense) {
+        local_sense = !local_sense;
+        if (count_.fetch_add(1, std::memory_order_acq_rel) == n_ - 1) {
+            count_.store(0, std::memory_order_relaxed);
+            sense_.store(local_sense);
+            if (sleepers_.load() > 0) {
+                // a sleeper either sees the new sense or is waiting on wakeup_
+                { std::lock_guard<std::mutex> lock(mutex_); }
+                wakeup_.notify_all();
+            }
+            return;
+        }
+        // spin briefly, the next job usually follows quickly, then sleep, e.g. between the
+        // jobs of the setup or while the master does the spike exchange
+        for (int i = 0; i < spin_count; ++i) {
+            if (sense_.load(std::memory_order_acquire) == local_sense) {
+                return;
+            }
+        }
+        sleepers_.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wakeup_.wait(lock, [&] { return sense_.load() == local_sense; });
+        }
+        sleepers_.fetch_sub(1);
+    }
+
+  private:
+    static constexpr int spin_count = 1 << 14;
+    int n_{1};
+    std::atomic<int> count_{0};
+    std::atomic<bool> sense_{false};
+    std::atomic<int> sleepers_{0};
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+};
+
+std::vector<std::thread> workers_;
+SenseBarrier barrier_;
+bool master_sense_;
+bool quit_;
+void (*job_fn_)(void*, NrnThread*);
+void* job_ctx_;
+int team_size_;
+// NrnThread ids run by each member
+std::vector<std::vector<int>> share_;
+// set on team members while they run a job
+thread_local bool in_job_;
+
+void run_share(int member) {
+    in_job_ = true;
+    for (int i: share_[member]) {
+        (*job_fn_)(job_ctx_, nrn_threads + i);
+    }
+    in_job_ = false;
+}
+
+#if defined(__linux__)
+// affinity of the master before it got pinned, restored when the team stops so
+// that later OpenMP pools and the host application do not inherit one core
+cpu_set_t master_mask_;
+bool master_pinned_ = false;
+
+void pin_to(pthread_t thread, int member) {
+    cpu_set_t available;
+    if (sched_getaffinity(0, sizeof(available), &available) != 0) {
+        return;
+    }
+    int ncpu = CPU_COUNT(&available);
+    if (ncpu == 0) {
+        return;
+    }
+    // the member'th cpu of the mask we were given, e.g. by the MPI launcher
+    int target = member % ncpu;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &available) && target-- == 0) {
+            cpu_set_t one;
+            CPU_ZERO(&one);
+            CPU_SET(cpu, &one);
+            pthread_setaffinity_np(thread, sizeof(one), &one);
+            return;
+        }
+    }
+}
+#endif
+
+void worker(int member) {
+    bool local_sense = false;
+    for (;;) {
+        barrier_.wait(local_sense);  // job posted
+        if (quit_) {
+            return;
+        }
+        run_share(member);
+        barrier_.wait(local_sense);  // job done
+    }
+}
+}  // namespace
+
+int nrn_thread_team_start(bool pin) {
+    nrn_thread_team_stop();
+    int size = std::min(nrn_nthread, omp_get_max_threads());
+    if (size < 2) {
+        return 0;
+    }
+    team_size_ = size;
+    share_.assign(size, {});
+    for (int i = 0; i < nrn_nthread; ++i) {
+        share_[i % size].push_back(i);
+    }
+    barrier_.reset(size);
+    master_sense_ = false;
+    quit_ = false;
+    for (int member = 1; member < size; ++member) {
+        workers_.emplace_back(worker, member);
+    }
+#if defined(__linux__)
+    if (pin) {
+        // pin_to reads the affinity mask of the master, so pin the master last
+        for (int member = 1; member < size; ++member) {
+            pin_to(workers_[member - 1].native_handle(), member);
+        }
+        master_pinned_ = sched_getaffinity(0, sizeof(master_mask_), &master_mask_) == 0;
+        if (master_pinned_) {
+            pin_to(pthread_self(), 0);
+        }
+    }
+#else
+    static_cast<void>(pin);
+#endif
+    return size;
+}
+
+void nrn_thread_team_stop() {
+    if (workers_.empty()) {
+        return;
+    }
+    quit_ = true;
+    barrier_.wait(master_sense_);
+    for (auto& w: workers_) {
+        w.join();
+    }
+    workers_.clear();
+    share_.clear();
+    team_size_ = 0;
+#if defined(__linux__)
+    if (master_pinned_) {
+        pthread_setaffinity_np(pthread_self(), sizeof(master_mask_), &master_mask_);
+        master_pinned_ = false;
+    }
+#endif
+}
+
+bool nrn_thread_team_active() {
+    return !workers_.empty();
+}
+
+bool nrn_thread_team_in_job() {
+    return in_job_;
+}
+
+int nrn_thread_team_size() {
+    return team_size_;
+}
+
+void nrn_thread_team_assign(const std::vector<int>& member_of) {
+    nrn_assert(!in_job_ && member_of.size() == std::size_t(nrn_nthread) && member_of[0] == 0);
+    for (auto& share: share_) {
+        share.clear();
+    }
+    for (int i = 0; i < nrn_nthread; ++i) {
+        nrn_assert(member_of[i] >= 0 && member_of[i] < team_size_);
+        share_[member_of[i]].push_back(i);
+    }
+}
+
+std::vector<int> nrn_thread_team_assignment() {
+    std::vector<int> member_of(share_.empty() ? 0 : nrn_nthread);
+    for (std::size_t member = 0; member < share_.size(); ++member) {
+        for (int i: share_[member]) {
+            member_of[i] = member;
+        }
+    }
+    return member_of;
+}
+
+void nrn_thread_team_run(void (*fn)(void*, NrnThread*), void* ctx) {
+    if (in_job_) {
+        // job posted from within a job, run it serially on this member
+        for (int i = 0; i < nrn_nthread; ++i) {
+            (*fn)(ctx, nrn_threads + i);
+        }
+        return;
+    }
+    job_fn_ = fn;
+    job_ctx_ = ctx;
+    barrier_.wait(master_sense_);
+    run_share(0);
+    barrier_.wait(master_sense_);
+}
+#else
+int nrn_thread_team_start(bool) {
+    return 0;
+}
+
+void nrn_thread_team_stop() {}
+
+bool nrn_thread_team_active() {
+    return false;
+}
+
+bool nrn_thread_team_in_job() {
+    return false;
+}
+
+int nrn_thread_team_size() {
+    return 0;
+}
+
+void nrn_thread_team_assign(const std::vector<int>&) {}
+
+std::vector<int> nrn_thread_team_assignment() {
+    return {};
+}
+
+void nrn_thread_team_run(void (*)(void*, NrnThread*), void*) {}
+#endif
+
+void nrn_thread_team_init() {
+    if (!corenrn_param.threading || !corenrn_param.thread_team) {
+        return;
+    }
+    int nteam = nrn_thread_team_start(corenrn_param.pin_threads);
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        if (nteam) {
+            printf(" Persistent thread team of %d threads%s\n",
+                   nteam,
+                   corenrn_param.pin_threads ? ", pinned" : "");
+        } else {
+            printf(" Notice: thread team requires OpenMP and more than one thread\n");
+        }
+    }
+}
+}  // namespace coreneuron
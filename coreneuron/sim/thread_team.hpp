@@ -0,0 +1,54 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+namespace coreneuron {
+struct NrnThread;
+
+/**
+ * \brief Persistent team of worker threads for nrn_multithread_job
+ *
+ * Instead of an OpenMP parallel region per job, the team is created once and
+ * its workers wait at a sense reversing barrier for jobs to be posted. The
+ * thread calling nrn_multithread_job takes part as member 0, so the job of
+ * NrnThread 0 keeps running on the master thread as MPI_THREAD_FUNNELED
+ * requires. Member w runs the jobs of the NrnThreads i with i % team size == w,
+ * i.e. a NrnThread is bound to the same (optionally pinned) core, until
+ * nrn_thread_team_assign changes the binding. Only available with OpenMP,
+ * since shared data is only locked (by OMP_Mutex, a std::mutex) in OpenMP
+ * builds. With pinning, the master gets its original affinity back when the
+ * team stops.
+ */
+
+/// Start the team for --thread-team (and --pin-threads) and report its size.
+/// Called by nrn_setup before the model data is read, so that the arrays of every
+/// NrnThread are allocated and first touched by the member that will integrate it.
+void nrn_thread_team_init();
+/// Start the team with one member per NrnThread, at most omp_get_max_threads()
+/// @param pin bind member w to the w-th cpu of the process affinity mask
+/// @return number of team members, 0 if the team is not available
+int nrn_thread_team_start(bool pin);
+void nrn_thread_team_stop();
+/// True if nrn_multithread_job should post jobs to the team
+bool nrn_thread_team_active();
+/// True on a team member while it runs a job
+bool nrn_thread_team_in_job();
+/// Number of team members, 0 if the team is not running
+int nrn_thread_team_size();
+/// From the next job on, let member member_of[i] run the jobs of NrnThread i.
+/// member_of[0] must be 0. Only call from the master between jobs.
+void nrn_thread_team_assign(const std::vector<int>& member_of);
+/// member_of of the current assignment, empty if the team is not running
+std::vector<int> nrn_thread_team_assignment();
+/// Run fn(ctx, nt) for every NrnThread on the team and wait for completion.
+/// Jobs posted from within a job run serially.
+void nrn_thread_team_run(void (*fn)(void*, NrnThread*), void* ctx);
+}  // namespace coreneuron
@@ -13,6 +13,8 @@
 #include "coreneuron/utils/profile/profiler_interface.h"
 #include "coreneuron/coreneuron.hpp"
 #include "coreneuron/utils/nrnoc_aux.hpp"
+#include "coreneuron/utils/utils.hpp"
+#include "coreneuron/io/group_cost.hpp"
 
 namespace coreneuron {
 /*
@@ -61,7 +63,11 @@ static void nrn_rhs(NrnThread* _nt) {
             std::string ss("cur-");
             ss += nrn_get_mechname(tml->index);
             Instrumentor::phase p(ss.c_str());
+            double wt = nrn_cost_calibrate_enabled ? nrn_wtime() : 0.;
             (*s)(_nt, tml->ml, tml->index);
+            if (nrn_cost_calibrate_enabled) {
+                nrn_cost_calibrate_mech_time(_nt, tml->index, nrn_wtime() - wt);
+            }
 #ifdef DEBUG
             if (errno) {
                 hoc_warning("errno set during calculation of currents", nullptr);
@@ -0,0 +1,104 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace coreneuron {
+
+/**
+ * \class FlatGidMap
+ * \brief Immutable open addressing hash table from gid to a pointer
+ *
+ * Built once from a std::map after setup and used for the lookups in the
+ * spike receive loops, where the node based std::map is a hotspot. Keys are
+ * stored contiguously with linear probing in a power of two table that is at
+ * most half full. Gids are non-negative, -1 marks an empty slot.
+ */
+template <typename T>
+class FlatGidMap {
+  public:
+    void build(const std::map<int, T*>& m) {
+        std::size_t capacity = 2;
+        shift_ = 63;
+        while (capacity < 2 * m.size()) {
+            capacity *= 2;
+            --shift_;
+        }
+        mask_ = capacity - 1;
+        keys_.assign(capacity, empty_key);
+        values_.assign(capacity, nullptr);
+        size_ = 0;
+        for (const auto& kv: m) {
+            std::size_t i = slot(kv.first);
+            while (keys_[i] != empty_key) {
+                i = (i + 1) & mask_;
+            }
+            keys_[i] = kv.first;
+            values_[i] = kv.second;
+            ++size_;
+        }
+    }
+
+    /// Return the value for gid, or nullptr if absent
+    T* find(int gid) const {
+        if (size_ == 0) {
+            return nullptr;
+        }
+        for (std::size_t i = slot(gid);; i = (i + 1) & mask_) {
+            int key = keys_[i];
+            if (key == gid) {
+                return values_[i];
+            }
+            if (key == empty_key) {
+                return nullptr;
+            }
+        }
+    }
+
+    void clear() {
+        keys_.clear();
+        keys_.shrink_to_fit();
+        values_.clear();
+        values_.shrink_to_fit();
+        size_ = 0;
+        mask_ = 0;
+        shift_ = 63;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    /// Bytes used by the table
+    std::size_t nbytes() const {
+        return keys_.capacity() * sizeof(int) + values_.capacity() * sizeof(T*);
+    }
+
+  private:
+    static constexpr int empty_key = -1;
+
+    // Fibonacci hashing spreads consecutive gids over the table
+    std::size_t slot(int gid) const {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(gid)) *
+                11400714819323198485ull) >>
+               shift_;
+    }
+
+    std::vector<int> keys_;
+    std::vector<T*> values_;
+    std::size_t mask_{};
+    std::size_t size_{};
+    int shift_{63};
+};
+
+}  // namespace coreneuron
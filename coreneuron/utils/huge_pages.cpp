@@ -0,0 +1,209 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+
+#include "coreneuron/utils/huge_pages.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/mpi/core/nrnmpi.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace coreneuron {
+
+#if defined(__linux__)
+namespace {
+struct Mapping {
+    std::size_t size;
+    bool hugetlb;
+};
+
+int mode_ = 0;
+std::mutex mutex_;
+std::map<std::uintptr_t, Mapping> mappings_;
+std::atomic<int> nmapping_{0};
+std::size_t nfallback_ = 0;
+
+void* map_hugetlb(std::size_t size) {
+    void* p = mmap(nullptr,
+                   size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                   -1,
+                   0);
+    return p == MAP_FAILED ? nullptr : p;
+}
+
+void* map_transparent(std::size_t size) {
+    // map one huge page more, so that the range can be aligned to 2 MB, and trim it
+    std::size_t len = size + huge_page_size;
+    void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        return nullptr;
+    }
+    auto begin = reinterpret_cast<std::uintptr_t>(p);
+    auto aligned = (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+    if (aligned > begin) {
+        munmap(p, aligned - begin);
+    }
+    if (begin + len > aligned + size) {
+        munmap(reinterpret_cast<void*>(aligned + size), begin + len - (aligned + size));
+    }
+    // without THP support the mapping still works with regular pages
+    madvise(reinterpret_cast<void*>(aligned), size, MADV_HUGEPAGE);
+    return reinterpret_cast<void*>(aligned);
+}
+
+// AnonHugePages of the transparent mappings, from /proc/self/smaps
+std::size_t count_transparent() {
+    FILE* f = fopen("/proc/self/smaps", "r");
+    if (!f) {
+        return 0;
+    }
+    std::size_t kb = 0;
+    bool ours = false;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long begin, end, n;
+        if (sscanf(line, "%lx-%lx ", &begin, &end) == 2) {
+            // a vma may hold several adjacent mappings, madvised ranges are merged
+            auto it = mappings_.lower_bound(end);
+            ours = false;
+            while (it != mappings_.begin()) {
+                --it;
+                if (it->first + it->second.size <= begin) {
+                    break;
+                }
+                ours = ours || !it->second.hugetlb;
+            }
+        } else if (ours && sscanf(line, "AnonHugePages: %lu kB", &n) == 1) {
+            kb += n;
+        }
+    }
+    fclose(f);
+    return kb * 1024 / huge_page_size;
+}
+}  // namespace
+
+void nrn_huge_pages_init(int mode) {
+    mode_ = mode;
+}
+
+void* nrn_huge_alloc(std::size_t nbytes) {
+    if (mode_ == 0 || nbytes < huge_page_size) {
+        return nullptr;
+    }
+    std::size_t size = (nbytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+    void* p = mode_ == 2 ? map_hugetlb(size) : nullptr;
+    bool hugetlb = p != nullptr;
+    if (!p) {
+        p = map_transparent(size);
+        if (!p) {
+            return nullptr;
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    mappings_[reinterpret_cast<std::uintptr_t>(p)] = {size, hugetlb};
+    nmapping_.fetch_add(1, std::memory_order_release);
+    if (mode_ == 2 && !hugetlb) {
+        ++nfallback_;
+    }
+    return p;
+}
+
+bool nrn_huge_free(void* p) {
+    if (nmapping_.load(std::memory_order_acquire) == 0 || !p) {
+        return false;
+    }
+    std::size_t size;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mappings_.find(reinterpret_cast<std::uintptr_t>(p));
+        if (it == mappings_.end()) {
+            return false;
+        }
+        size = it->second.size;
+        mappings_.erase(it);
+        nmapping_.fetch_sub(1, std::memory_order_release);
+    }
+    munmap(p, size);
+    return true;
+}
+
+void nrn_huge_pages_count(std::size_t& nhugetlb, std::size_t& ntransparent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nhugetlb = 0;
+    for (const auto& m: mappings_) {
+        if (m.second.hugetlb) {
+            nhugetlb += m.second.size / huge_page_size;
+        }
+    }
+    ntransparent = count_transparent();
+}
+
+void nrn_huge_pages_report() {
+    if (mode_ == 0) {
+        return;
+    }
+    std::size_t nhugetlb, ntransparent;
+    nrn_huge_pages_count(nhugetlb, ntransparent);
+    double v[4] = {double(nhugetlb), double(ntransparent), 0., 0.};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& m: mappings_) {
+            v[2] += m.second.size;
+        }
+        v[3] = nfallback_;
+    }
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        double all[4];
+        nrnmpi_dbl_allreduce_vec(v, all, 4, 1);
+        std::copy(all, all + 4, v);
+    }
+#endif
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet()) {
+        printf(" Huge pages: %.0f hugetlbfs and %.0f transparent 2 MB pages for %.1f MB of "
+               "large arrays\n",
+               v[0],
+               v[1],
+               v[2] / (1024. * 1024.));
+        if (v[3] > 0.) {
+            printf(" Notice: %.0f allocations fell back from hugetlbfs to transparent huge "
+                   "pages\n",
+                   v[3]);
+        }
+    }
+}
+#else
+void nrn_huge_pages_init(int) {}
+
+void* nrn_huge_alloc(std::size_t) {
+    return nullptr;
+}
+
+bool nrn_huge_free(void*) {
+    return false;
+}
+
+void nrn_huge_pages_count(std::size_t& nhugetlb, std::size_t& ntransparent) {
+    nhugetlb = 0;
+    ntransparent = 0;
+}
+
+void nrn_huge_pages_report() {}
+#endif
+}  // namespace coreneuron
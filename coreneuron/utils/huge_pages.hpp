@@ -0,0 +1,39 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+
+namespace coreneuron {
+
+/**
+ * \brief Back large model arrays with 2 MB pages (--huge-pages)
+ *
+ * Mode 1 maps allocations of at least huge_page_size anonymously, aligned to
+ * 2 MB, and asks for transparent huge pages with madvise(MADV_HUGEPAGE). Mode 2
+ * takes them from the hugetlbfs pool with MAP_HUGETLB and falls back to mode 1
+ * when the pool is exhausted or not configured. alloc_memory, and hence
+ * emalloc_align and ecalloc_align, as well as the chunks of the thread arenas
+ * use nrn_huge_alloc; free_memory returns the mapping with nrn_huge_free. Arena
+ * chunks are rounded up to 2 MB, so that small models get huge pages too.
+ * Linux only, elsewhere the mode is ignored.
+ */
+constexpr std::size_t huge_page_size = std::size_t(2) << 20;
+
+/// Select the mode for the following allocations: 0 off, 1 madvise, 2 hugetlbfs
+void nrn_huge_pages_init(int mode);
+/// Map nbytes with huge pages, nullptr if off, too small or the mapping failed
+void* nrn_huge_alloc(std::size_t nbytes);
+/// Unmap p if it came from nrn_huge_alloc, otherwise return false
+bool nrn_huge_free(void* p);
+/// Huge pages backing the current mappings (hugetlbfs, transparent)
+void nrn_huge_pages_count(std::size_t& nhugetlb, std::size_t& ntransparent);
+/// Print the huge pages of all ranks on rank 0
+void nrn_huge_pages_report();
+}  // namespace coreneuron
@@ -12,6 +12,7 @@
 #include <cstring>
 #include <memory>
 
+#include "coreneuron/utils/huge_pages.hpp"
 #include "coreneuron/utils/nrn_assert.h"
 #include "coreneuron/nrniv/nrniv_decl.h"
 
@@ -22,6 +23,15 @@
 #endif
 
 namespace coreneuron {
+class BumpArena;
+/// Arena of the NrnThread the calling thread sets up, see thread_arena.hpp
+extern thread_local BumpArena* nrn_current_arena;
+void* nrn_arena_alloc(BumpArena* arena, std::size_t nbytes, std::size_t alignment);
+/// True if p was allocated from an arena, free_memory must not free it
+bool nrn_arena_owns(const void* p);
+/// If p was allocated from an arena, give it back to the current arena and return true
+bool nrn_arena_free(void* p);
+
 /**
  * @brief Check if GPU support is enabled.
  *
@@ -176,6 +186,11 @@ class MemoryManaged {
 #include <cstdlib>
 
 inline void alloc_memory(void*& pointer, size_t num_bytes, size_t alignment) {
+    // large arrays are 2 MB aligned mappings with --huge-pages
+    if (num_bytes >= coreneuron::huge_page_size &&
+        (pointer = coreneuron::nrn_huge_alloc(num_bytes)) != nullptr) {
+        return;
+    }
     size_t fill = 0;
     if (alignment > 0) {
         if (num_bytes % alignment != 0) {
@@ -194,6 +209,12 @@ inline void calloc_memory(void*& pointer, size_t num_bytes, size_t alignment) {
 }
 
 inline void free_memory(void* pointer) {
+    if (coreneuron::nrn_arena_free(pointer)) {
+        return;
+    }
+    if (coreneuron::nrn_huge_free(pointer)) {
+        return;
+    }
     free(pointer);
 }
 
@@ -224,12 +245,20 @@ inline bool is_aligned(void* pointer, std::size_t alignment) {
 
 /**
  * Allocate aligned memory. This will be unified memory if the corresponding
- * CMake option is set. This must be freed with the free_memory method.
+ * CMake option is set, or come from the current NrnThread arena if any. This
+ * must be freed with the free_memory method.
  *
  * \param size      Size of buffer to allocate in bytes.
  * \param alignment Memory alignment, defaults to NRN_SOA_BYTE_ALIGN. Pass 0 for no alignment.
  */
 inline void* emalloc_align(size_t size, size_t alignment = NRN_SOA_BYTE_ALIGN) {
+#ifndef CORENEURON_UNIFIED_MEMORY
+    if (nrn_current_arena) {
+        if (void* p = nrn_arena_alloc(nrn_current_arena, size, alignment)) {
+            return p;
+        }
+    }
+#endif
     void* memptr;
     alloc_memory(memptr, size, alignment);
     if (alignment != 0) {
@@ -254,6 +283,15 @@ inline void* ecalloc_align(size_t n, size_t size, size_t alignment = NRN_SOA_BYT
     if (n == 0) {
         return nullptr;
     }
+#ifndef CORENEURON_UNIFIED_MEMORY
+    if (nrn_current_arena) {
+        p = nrn_arena_alloc(nrn_current_arena, n * size, alignment);
+        if (p) {
+            memset(p, 0, n * size);
+            return p;
+        }
+    }
+#endif
     calloc_memory(p, n * size, alignment);
     if (alignment != 0) {
         nrn_assert(is_aligned(p, alignment));
@@ -8,20 +8,18 @@
 #pragma once
 
 #if defined(_OPENMP)
-#include <omp.h>
+#include <mutex>
 
-// This class respects the requirement *Mutex*
+// This class respects the requirement *Mutex*. It is a std::mutex rather than an
+// OpenMP lock, since the members of the thread team are std::threads, for which
+// OpenMP locks are not specified.
 class OMP_Mutex {
   public:
     // Default constructible
-    OMP_Mutex() {
-        omp_init_lock(&mut_);
-    }
+    OMP_Mutex() = default;
 
     // Destructible
-    ~OMP_Mutex() {
-        omp_destroy_lock(&mut_);
-    }
+    ~OMP_Mutex() = default;
 
     // Not copyable
     OMP_Mutex(const OMP_Mutex&) = delete;
@@ -33,20 +31,20 @@ class OMP_Mutex {
 
     // Basic Lockable
     void lock() {
-        omp_set_lock(&mut_);
+        mut_.lock();
     }
 
     void unlock() {
-        omp_unset_lock(&mut_);
+        mut_.unlock();
     }
 
     // Lockable
     bool try_lock() {
-        return omp_test_lock(&mut_) != 0;
+        return mut_.try_lock();
     }
 
   private:
-    omp_lock_t mut_;
+    std::mutex mut_;
 };
 
 #else
@@ -0,0 +1,233 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+
+#include "coreneuron/utils/thread_arena.hpp"
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/mpi/nrnmpi.h"
+#include "coreneuron/mpi/core/nrnmpi.hpp"
+#include "coreneuron/utils/huge_pages.hpp"
+#include "coreneuron/utils/memory.h"
+
+namespace coreneuron {
+
+thread_local BumpArena* nrn_current_arena = nullptr;
+
+namespace {
+std::vector<std::unique_ptr<BumpArena>> arenas_;
+}  // namespace
+
+void* nrn_arena_alloc(BumpArena* arena, std::size_t nbytes, std::size_t alignment) {
+    return arena->allocate(nbytes, alignment);
+}
+
+bool nrn_arena_owns(const void* p) {
+    return std::any_of(arenas_.begin(), arenas_.end(), [p](const std::unique_ptr<BumpArena>& a) {
+        return a->owns(p);
+    });
+}
+
+bool nrn_arena_free(void* p) {
+    for (const auto& a: arenas_) {
+        if (a->owns(p)) {
+            // outside the setup job of its NrnThread it stays until the arena is released
+            if (a.get() == nrn_current_arena) {
+                a->deallocate(p);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BumpArena::owns(const void* p) const {
+    auto a = reinterpret_cast<std::uintptr_t>(p);
+    if (a < lowest_.load(std::memory_order_acquire) ||
+        a >= highest_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    int n = nrange_.load(std::memory_order_acquire);
+    for (int i = 0; i < n; ++i) {
+        if (a >= range_begin_[i].load(std::memory_order_relaxed) &&
+            a < range_end_[i].load(std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void* BumpArena::reuse(std::size_t nbytes, std::size_t alignment) {
+    // a freed block of at most twice the size, so that large blocks are not wasted
+    for (auto it = free_blocks_.lower_bound(nbytes);
+         it != free_blocks_.end() && it->first <= 2 * nbytes;
+         ++it) {
+        if (reinterpret_cast<std::uintptr_t>(it->second) % alignment == 0) {
+            char* p = it->second;
+            block_size_[p] = it->first;
+            used_ += it->first;
+            free_blocks_.erase(it);
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+void* BumpArena::allocate(std::size_t nbytes, std::size_t alignment) {
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    nrn_assert(alignment <= chunk_alignment);
+    nbytes = std::max(nbytes, std::size_t(1));
+    if (void* p = reuse(nbytes, alignment)) {
+        return p;
+    }
+    char* p = nullptr;
+    if (!chunks_.empty()) {
+        auto& c = chunks_.back();
+        std::size_t offset = (c.used + alignment - 1) / alignment * alignment;
+        if (offset + nbytes <= c.size) {
+            c.used = offset + nbytes;
+            p = c.base + offset;
+        }
+    }
+    if (!p && nrange_.load(std::memory_order_relaxed) == max_chunks) {
+        return nullptr;
+    }
+    if (!p && nbytes > next_chunk_size_ / 2) {
+        // large requests, like _data, get a chunk of their own and the current one stays open
+        Chunk c = new_chunk(nbytes);
+        c.used = nbytes;
+        chunks_.insert(chunks_.empty() ? chunks_.end() : chunks_.end() - 1, c);
+        p = c.base;
+    } else if (!p) {
+        Chunk c = new_chunk(next_chunk_size_);
+        next_chunk_size_ = std::min(2 * next_chunk_size_, max_chunk_size);
+        c.used = nbytes;
+        chunks_.push_back(c);
+        p = c.base;
+    }
+    used_ += nbytes;
+    block_size_[p] = nbytes;
+    return p;
+}
+
+void BumpArena::deallocate(void* p) {
+    auto it = block_size_.find(p);
+    if (it == block_size_.end()) {
+        return;
+    }
+    std::size_t nbytes = it->second;
+    block_size_.erase(it);
+    used_ -= nbytes;
+    char* cp = static_cast<char*>(p);
+    // the top of the open chunk is popped, everything else waits for reuse
+    auto& c = chunks_.back();
+    if (cp + nbytes == c.base + c.used) {
+        c.used = cp - c.base;
+        return;
+    }
+    free_blocks_.emplace(nbytes, cp);
+}
+
+BumpArena::Chunk BumpArena::new_chunk(std::size_t size) {
+    // with huge pages, chunks are whole 2 MB pages, the first small ones included
+    std::size_t huge_size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+    char* base = static_cast<char*>(nrn_huge_alloc(huge_size));
+    if (base) {
+        size = huge_size;
+    } else {
+        size = (size + chunk_alignment - 1) / chunk_alignment * chunk_alignment;
+        base = static_cast<char*>(std::aligned_alloc(chunk_alignment, size));
+    }
+    nrn_assert(base);
+    auto begin = reinterpret_cast<std::uintptr_t>(base);
+    // publish the range before owns() can see it in nrange_ or the bounds
+    int n = nrange_.load(std::memory_order_relaxed);
+    range_begin_[n].store(begin, std::memory_order_relaxed);
+    range_end_[n].store(begin + size, std::memory_order_relaxed);
+    nrange_.store(n + 1, std::memory_order_release);
+    if (begin < lowest_.load(std::memory_order_relaxed)) {
+        lowest_.store(begin, std::memory_order_release);
+    }
+    if (begin + size > highest_.load(std::memory_order_relaxed)) {
+        highest_.store(begin + size, std::memory_order_release);
+    }
+    reserved_ += size;
+    return {base, size, 0};
+}
+
+void BumpArena::release() {
+    if (chunks_.empty()) {
+        return;
+    }
+    nrange_.store(0, std::memory_order_release);
+    lowest_.store(UINTPTR_MAX, std::memory_order_release);
+    highest_.store(0, std::memory_order_release);
+    for (const auto& c: chunks_) {
+        if (!nrn_huge_free(c.base)) {
+            std::free(c.base);
+        }
+    }
+    chunks_.clear();
+    block_size_.clear();
+    free_blocks_.clear();
+    used_ = 0;
+    reserved_ = 0;
+    next_chunk_size_ = min_chunk_size;
+}
+
+NrnThreadArenaScope::NrnThreadArenaScope(int id)
+    : previous_(nrn_current_arena) {
+    if (id < static_cast<int>(arenas_.size())) {
+        nrn_current_arena = arenas_[id].get();
+    }
+}
+
+NrnThreadArenaScope::~NrnThreadArenaScope() {
+    nrn_current_arena = previous_;
+}
+
+void nrn_thread_arenas_create(int nthread) {
+#ifndef CORENEURON_UNIFIED_MEMORY
+    nrn_thread_arenas_free();
+    for (int i = 0; i < nthread; ++i) {
+        arenas_.emplace_back(new BumpArena);
+    }
+#else
+    static_cast<void>(nthread);
+#endif
+}
+
+void nrn_thread_arenas_free() {
+    arenas_.clear();
+}
+
+void nrn_thread_arena_report() {
+    double v[3] = {0., 0., 0.};
+    for (const auto& a: arenas_) {
+        v[0] += a->nbytes_used();
+        v[1] += a->nbytes_reserved();
+        v[2] += a->nchunk();
+    }
+#if NRNMPI
+    if (corenrn_param.mpi_enable) {
+        double all[3];
+        nrnmpi_dbl_allreduce_vec(v, all, 3, 1);
+        std::copy(all, all + 3, v);
+    }
+#endif
+    if (nrnmpi_myid == 0 && !corenrn_param.is_quiet() && v[2] > 0.) {
+        printf(" Thread arenas: %.1f MB of model data in %.1f MB reserved, %.0f chunks\n",
+               v[0] / (1024. * 1024.),
+               v[1] / (1024. * 1024.),
+               v[2]);
+    }
+}
+}  // namespace coreneuron
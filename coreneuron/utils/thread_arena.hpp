@@ -0,0 +1,110 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace coreneuron {
+
+/**
+ * \class BumpArena
+ * \brief Bump allocator for the simulation lifetime data of one NrnThread
+ *
+ * Memory is handed out contiguously from large chunks and returned all at once
+ * by release(). With --thread-arena every NrnThread has an arena and, while a
+ * thread holds a NrnThreadArenaScope, emalloc_align and ecalloc_align are
+ * served from it. The setup jobs of the reader phases hold the scope, so tml,
+ * Memb_list, _data, nodeindices, pdata, weights and the other aligned arrays
+ * of a NrnThread end up next to each other and are freed in one go at the end
+ * of nrn_cleanup. The temporaries a setup job frees go back to the arena: the
+ * top of a chunk is popped and other blocks are reused by later allocations of
+ * the job. free_memory of an arena pointer outside the scope does nothing.
+ * Not available with CORENEURON_UNIFIED_MEMORY.
+ */
+class BumpArena {
+  public:
+    BumpArena() = default;
+    BumpArena(const BumpArena&) = delete;
+    BumpArena& operator=(const BumpArena&) = delete;
+    ~BumpArena() {
+        release();
+    }
+
+    /// nullptr when the arena has max_chunks chunks, allocate elsewhere then
+    void* allocate(std::size_t nbytes, std::size_t alignment);
+    /// Return a block of this arena, only from the thread that allocates
+    void deallocate(void* p);
+    /// Whether p points into a chunk, lock free and safe while another thread allocates
+    bool owns(const void* p) const;
+    void release();
+
+    std::size_t nbytes_used() const {
+        return used_;
+    }
+    std::size_t nbytes_reserved() const {
+        return reserved_;
+    }
+    std::size_t nchunk() const {
+        return chunks_.size();
+    }
+
+  private:
+    struct Chunk {
+        char* base;
+        std::size_t size;
+        std::size_t used;
+    };
+    Chunk new_chunk(std::size_t size);
+    void* reuse(std::size_t nbytes, std::size_t alignment);
+
+    static constexpr int max_chunks = 256;
+
+    std::vector<Chunk> chunks_;
+    // the chunk ranges for owns(), the first nrange_ entries are valid
+    std::atomic<std::uintptr_t> range_begin_[max_chunks]{};
+    std::atomic<std::uintptr_t> range_end_[max_chunks]{};
+    std::atomic<int> nrange_{0};
+    std::atomic<std::uintptr_t> lowest_{UINTPTR_MAX};
+    std::atomic<std::uintptr_t> highest_{0};
+    // size of the live blocks and the freed blocks by size
+    std::unordered_map<const void*, std::size_t> block_size_;
+    std::multimap<std::size_t, char*> free_blocks_;
+    std::size_t used_{};
+    std::size_t reserved_{};
+    std::size_t next_chunk_size_{min_chunk_size};
+
+    static constexpr std::size_t min_chunk_size = std::size_t(1) << 20;
+    static constexpr std::size_t max_chunk_size = std::size_t(64) << 20;
+    static constexpr std::size_t chunk_alignment = 4096;
+};
+
+/// Let the calling thread allocate from the arena of NrnThread id while in scope
+class NrnThreadArenaScope {
+  public:
+    explicit NrnThreadArenaScope(int id);
+    ~NrnThreadArenaScope();
+    NrnThreadArenaScope(const NrnThreadArenaScope&) = delete;
+    NrnThreadArenaScope& operator=(const NrnThreadArenaScope&) = delete;
+
+  private:
+    BumpArena* previous_;
+};
+
+/// Create one arena per NrnThread
+void nrn_thread_arenas_create(int nthread);
+/// Release all arenas, after everything allocated from them is gone
+void nrn_thread_arenas_free();
+/// Print the arena memory of all ranks on rank 0
+void nrn_thread_arena_report();
+}  // namespace coreneuron
@@ -0,0 +1,127 @@
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================
+"""Replicate the cell groups of a file mode dataset.
+
+    python replicate_dataset.py <datpath> <outpath> <copies>
+
+Writes a dataset with <copies> independent copies of the network of
+<datpath>, e.g. to have more cell groups than the two of the ring datasets.
+Each copy offsets the gids of phase1 and the gap junction sids, so the
+copies do not connect, and the reference spikes are replicated with the
+offset gids. Phase 3 is not rewritten, the copies are not meant for reports.
+"""
+
+import os
+import shutil
+import struct
+import sys
+
+
+class DatFile:
+    """A phase file: text header lines and binary int arrays, each array
+    preceded by a "chkpnt <n>" line."""
+
+    def __init__(self, path, nheader, sizes):
+        with open(path, "rb") as f:
+            data = f.read()
+        pos = 0
+        self.header = []
+        for _ in range(nheader):
+            end = data.index(b"\n", pos) + 1
+            self.header.append(data[pos:end])
+            pos = end
+        counts = [int(line.split()[0]) for line in self.header[1:]]
+        self.arrays = []
+        for i, size in enumerate(sizes(counts)):
+            marker = b"chkpnt %d\n" % i
+            assert data.startswith(marker, pos), path
+            pos += len(marker)
+            self.arrays.append(list(struct.unpack_from("<%di" % size, data, pos)))
+            pos += 4 * size
+        assert pos == len(data), path
+
+    def write(self, path):
+        with open(path, "wb") as f:
+            f.write(b"".join(self.header))
+            for i, values in enumerate(self.arrays):
+                f.write(b"chkpnt %d\n" % i)
+                f.write(struct.pack("<%di" % len(values), *values))
+
+
+def phase1(path):
+    # version, npresyn, nnetcon; output gids, netcon source gids
+    return DatFile(path, 3, lambda c: [c[0], c[1]])
+
+
+def phasegap(path):
+    # version, sizeof(sid), ntar, nsrc; source sid, type, index and
+    # target sid, type, index
+    return DatFile(path, 4, lambda c: [c[2]] * 3 + [c[1]] * 3)
+
+
+def main(datpath, outpath, copies):
+    with open(os.path.join(datpath, "files.dat")) as f:
+        lines = f.read().split()
+    version, lines = lines[0], lines[1:]
+    has_gaps = lines[0] == "-1"
+    if has_gaps:
+        lines = lines[1:]
+    groups = lines[1 : 1 + int(lines[0])]
+
+    p1 = {g: phase1(os.path.join(datpath, g + "_1.dat")) for g in groups}
+    gid_offset = 1 + max(max(p.arrays[0] + p.arrays[1]) for p in p1.values())
+    gap = {}
+    if has_gaps:
+        gap = {g: phasegap(os.path.join(datpath, g + "_gap.dat")) for g in groups}
+        sid_offset = 1 + max(max(p.arrays[0] + p.arrays[3] + [-1]) for p in gap.values())
+
+    os.makedirs(outpath, exist_ok=True)
+    for name in ("bbcore_mech.dat", "globals.dat"):
+        shutil.copy(os.path.join(datpath, name), outpath)
+
+    new_groups = []
+    ngroup_id = 1 + max(int(g) for g in groups)
+    for copy in range(copies):
+        for g in groups:
+            new_g = str(int(g) + copy * ngroup_id)
+            new_groups.append(new_g)
+            for phase in ("_2.dat", "_3.dat"):
+                shutil.copy(os.path.join(datpath, g + phase), os.path.join(outpath, new_g + phase))
+            # negative gids are local to the group and stay as they are
+            p = p1[g]
+            saved = [list(a) for a in p.arrays]
+            for a in p.arrays:
+                a[:] = [x + copy * gid_offset if x >= 0 else x for x in a]
+            p.write(os.path.join(outpath, new_g + "_1.dat"))
+            p.arrays = saved
+            if has_gaps:
+                p = gap[g]
+                saved = [list(a) for a in p.arrays]
+                for i in (0, 3):
+                    p.arrays[i] = [x + copy * sid_offset for x in p.arrays[i]]
+                p.write(os.path.join(outpath, new_g + "_gap.dat"))
+                p.arrays = saved
+
+    with open(os.path.join(outpath, "files.dat"), "w") as f:
+        f.write("\n".join([version] + (["-1"] if has_gaps else []) + [str(len(new_groups))] +
+                          new_groups) + "\n")
+
+    # the copies spike at the same times as the original network
+    spikes = []
+    with open(os.path.join(datpath, "out.dat.ref")) as f:
+        for line in f:
+            t, gid = line.split()
+            for copy in range(copies):
+                spikes.append((float(t), int(gid) + copy * gid_offset, t))
+    spikes.sort()
+    with open(os.path.join(outpath, "out.dat.ref"), "w") as f:
+        f.writelines("%s %d\n" % (t, gid) for _, gid, t in spikes)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 4:
+        sys.exit(__doc__)
+    main(sys.argv[1], sys.argv[2], int(sys.argv[3]))
@@ -0,0 +1,275 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+#include "coreneuron/io/array_compression.hpp"
+#include "coreneuron/io/dataset_container.hpp"
+#include "coreneuron/io/nrn_filehandler.hpp"
+#include "coreneuron/io/phase_prefetch.hpp"
+
+#define BOOST_TEST_MODULE FileHandler
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace coreneuron;
+
+namespace {
+const std::string fname = "file_handler_test_1.dat";
+
+void write_file() {
+    FileHandler w;
+    w.open(fname, std::ios::out);
+    w << 3 << "\n";
+    int ints[3] = {1, 2, 3};
+    w.write_array(ints, 3);
+    double dbls[2] = {1.5, -2.5};
+    w.write_array(dbls, 2);
+    w << 7 << "\n";
+    w.close();
+}
+
+void check_contents(FileHandler& r) {
+    BOOST_CHECK(r.read_int() == 3);
+    auto ints = r.map_array<int>(3);
+    auto dbls = r.map_array<double>(2);
+    BOOST_CHECK(ints.size() == 3);
+    BOOST_CHECK(ints[0] == 1 && ints[2] == 3);
+    double out[2];
+    dbls.copy_to(out);
+    BOOST_CHECK(out[0] == 1.5 && out[1] == -2.5);
+    BOOST_CHECK(r.read_int() == 7);
+    BOOST_CHECK(r.eof());
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(stream_and_mmap_input) {
+    write_file();
+    for (bool use_mmap: {false, true}) {
+        FileHandler::use_mmap = use_mmap;
+        FileHandler r(fname);
+        check_contents(r);
+    }
+    FileHandler::use_mmap = false;
+    std::remove(fname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(prefetched_input) {
+    write_file();
+    PhasePrefetcher prefetcher;
+    prefetcher.queue({fname, "file_handler_test_missing.dat"});
+    std::vector<char> contents;
+    BOOST_CHECK(!prefetcher.take("file_handler_test_not_queued.dat", contents));
+    BOOST_CHECK(!prefetcher.take("file_handler_test_missing.dat", contents));
+    BOOST_REQUIRE(prefetcher.take(fname, contents));
+    FileHandler r;
+    r.open(fname, std::move(contents));
+    check_contents(r);
+    // a file is handed over only once
+    BOOST_CHECK(!prefetcher.take(fname, contents));
+    prefetcher.stop();
+    std::remove(fname.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(prefetch_window) {
+    std::vector<std::string> files;
+    for (int i = 0; i < 4; ++i) {
+        files.push_back("file_handler_test_window" + std::to_string(i) + ".dat");
+        std::ofstream(files.back()) << "file " << i << "\n";
+    }
+    PhasePrefetcher prefetcher;
+    prefetcher.set_window(1, 1);
+    prefetcher.queue(files);
+    // with a window of one file, taking the last file first must not wait on the others
+    std::vector<char> contents;
+    BOOST_REQUIRE(prefetcher.take(files[3], contents));
+    BOOST_CHECK(std::string(contents.begin(), contents.end()) == "file 3\n");
+    for (int i = 0; i < 3; ++i) {
+        BOOST_REQUIRE(prefetcher.take(files[i], contents));
+        BOOST_CHECK(std::string(contents.begin(), contents.end()) ==
+                    "file " + std::to_string(i) + "\n");
+    }
+    prefetcher.stop();
+    for (const auto& file: files) {
+        std::remove(file.c_str());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dataset_container_input) {
+    write_file();
+    std::ifstream in(fname, std::ios::binary);
+    std::vector<char> contents((std::istreambuf_iterator<char>(in)),
+                               std::istreambuf_iterator<char>());
+    BOOST_REQUIRE(!contents.empty());
+    {
+        DatasetContainerWriter w("file_handler_test.cnt");
+        w.add(5, nrn_dataset_phase_of("1"), {'x'});
+        w.add(42, nrn_dataset_phase_of("gap"), contents);
+    }
+    std::remove(fname.c_str());
+    nrn_dataset_containers_open(".", {"file_handler_test.cnt"}, {5, 42}, {0, 0});
+
+    BOOST_CHECK(FileHandler::file_exist("./42_gap.dat"));
+    BOOST_CHECK(!FileHandler::file_exist("./42_2.dat"));
+    BOOST_CHECK(!FileHandler::file_exist("./7_gap.dat"));
+    std::vector<char> data;
+    BOOST_REQUIRE(nrn_dataset_container_read("./5_1.dat", data));
+    BOOST_CHECK(data.size() == 1 && data[0] == 'x');
+    BOOST_CHECK(!nrn_dataset_container_read("other/5_1.dat", data));
+
+    // FileHandler reads files of a packed dataset transparently
+    FileHandler r("./42_gap.dat");
+    check_contents(r);
+    r.close();
+    // and so does the prefetcher
+    PhasePrefetcher prefetcher;
+    prefetcher.queue({"./42_gap.dat"});
+    BOOST_REQUIRE(prefetcher.take("./42_gap.dat", data));
+    BOOST_CHECK(data == contents);
+    prefetcher.stop();
+
+    nrn_dataset_containers_close();
+    BOOST_CHECK(!FileHandler::file_exist("./42_gap.dat"));
+    std::remove("file_handler_test.cnt");
+}
+
+namespace {
+// arrays as found in phase2 files: sorted node indices, smooth voltages and
+// state, random synaptic weights
+std::vector<int> node_indices(std::size_t n) {
+    std::vector<int> v(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        v[i] = static_cast<int>(i + i / 7);
+    }
+    return v;
+}
+
+std::vector<double> model_data(std::size_t n, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::normal_distribution<double> noise(0., 1e-3);
+    std::uniform_real_distribution<double> weight(0., 1.);
+    std::vector<double> v(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        // a third each of constants, smooth values and random weights
+        switch (i % 3) {
+            case 0:
+                v[i] = 0.001;
+                break;
+            case 1:
+                v[i] = -65. + std::sin(i * 1e-4) + noise(gen);
+                break;
+            default:
+                v[i] = weight(gen);
+        }
+    }
+    return v;
+}
+
+template <typename T>
+bool round_trip(const std::vector<T>& v, bool parallel) {
+    auto z = array_compression::encode(
+        v.data(), v.size() * sizeof(T), sizeof(T), std::is_integral<T>::value, parallel);
+    std::vector<T> back(v.size());
+    return array_compression::decode(z.data(), z.size(), back.data(), v.size() * sizeof(T),
+                                     parallel) &&
+           back == v;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(array_compression_round_trip) {
+    BOOST_CHECK(round_trip(std::vector<int>{}, false));
+    BOOST_CHECK(round_trip(std::vector<int>{7}, false));
+    BOOST_CHECK(round_trip(node_indices(5), false));
+    // several chunks, the last one partial
+    std::size_t n = 3 * array_compression::chunk_bytes / sizeof(int) + 123;
+    BOOST_CHECK(round_trip(node_indices(n), false));
+    BOOST_CHECK(round_trip(node_indices(n), true));
+    BOOST_CHECK(round_trip(model_data(n, 1), true));
+    // incompressible chunks are stored as is
+    std::mt19937 gen(2);
+    std::vector<int> noise(n);
+    for (auto& x: noise) {
+        x = static_cast<int>(gen());
+    }
+    BOOST_CHECK(round_trip(noise, true));
+    // long runs exercise the overlapping matches and the extra length bytes
+    std::vector<double> runs(n, 1.5);
+    BOOST_CHECK(round_trip(runs, false));
+
+    // corrupt input is detected
+    auto v = node_indices(n);
+    auto z = array_compression::encode(v.data(), v.size() * sizeof(int), sizeof(int), true, false);
+    BOOST_CHECK(!array_compression::decode(z.data(), z.size() - 1, v.data(), v.size() * 4, false));
+    BOOST_CHECK(!array_compression::decode(z.data(), z.size(), v.data(), v.size() * 4 - 4, false));
+}
+
+BOOST_AUTO_TEST_CASE(compressed_arrays_in_files) {
+    auto ints = node_indices(10000);
+    auto dbls = model_data(10000, 3);
+    {
+        FileHandler w;
+        w.open(fname, std::ios::out);
+        w.compress(true);
+        w << 1 << "\n";
+        w.write_array(ints.data(), ints.size());
+        w.write_array(dbls.data(), dbls.size());
+        // small arrays are not compressed
+        w.write_array(ints.data(), 3);
+        w.close();
+    }
+    for (bool use_mmap: {false, true}) {
+        FileHandler::use_mmap = use_mmap;
+        FileHandler r(fname);
+        BOOST_CHECK(r.read_int() == 1);
+        BOOST_CHECK(r.read_vector<int>(ints.size()) == ints);
+        auto mapped = r.map_array<double>(dbls.size());
+        std::vector<double> back(dbls.size());
+        mapped.copy_to(back.data());
+        BOOST_CHECK(back == dbls);
+        auto small = r.map_array<int>(3);
+        BOOST_CHECK(small[2] == ints[2]);
+        BOOST_CHECK(r.eof());
+    }
+    FileHandler::use_mmap = false;
+    std::remove(fname.c_str());
+}
+
+// Compression ratio and throughput of the codec for phase2 like data. Reading a
+// compressed file pays off while the decode throughput exceeds the file system
+// bandwidth divided by the compression ratio. Disabled by default, run it with
+// --run_test=array_compression_benchmark --log_level=message
+BOOST_AUTO_TEST_CASE(array_compression_benchmark, *boost::unit_test::disabled()) {
+    std::size_t n = 8 * 1024 * 1024;
+    auto ints = node_indices(n);
+    auto dbls = model_data(n, 4);
+    using clock = std::chrono::steady_clock;
+    for (bool parallel: {false, true}) {
+        auto t0 = clock::now();
+        auto zi = array_compression::encode(ints.data(), n * sizeof(int), sizeof(int), true,
+                                            parallel);
+        auto zd = array_compression::encode(dbls.data(), n * sizeof(double), sizeof(double),
+                                            false, parallel);
+        auto t1 = clock::now();
+        BOOST_CHECK(array_compression::decode(zi.data(), zi.size(), ints.data(),
+                                              n * sizeof(int), parallel));
+        BOOST_CHECK(array_compression::decode(zd.data(), zd.size(), dbls.data(),
+                                              n * sizeof(double), parallel));
+        auto t2 = clock::now();
+        double mb = n * (sizeof(int) + sizeof(double)) / 1e6;
+        BOOST_TEST_MESSAGE((parallel ? "parallel" : "serial")
+                           << " int ratio " << double(n * sizeof(int)) / zi.size()
+                           << " double ratio " << double(n * sizeof(double)) / zd.size()
+                           << " encode MB/s " << mb / std::chrono::duration<double>(t1 - t0).count()
+                           << " decode MB/s "
+                           << mb / std::chrono::duration<double>(t2 - t1).count());
+    }
+}
@@ -0,0 +1,122 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+#include "coreneuron/utils/flat_gid_map.hpp"
+
+#define BOOST_TEST_MODULE FlatGidMap
+#include <boost/test/included/unit_test.hpp>
+
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace coreneuron;
+
+namespace {
+struct Item {
+    int gid;
+};
+
+// sparse gids as they appear in gid2in: a subset of a large gid range
+std::map<int, Item*> make_map(std::vector<Item>& items, int n, int range, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, range - 1);
+    std::map<int, Item*> m;
+    items.resize(n);
+    while (static_cast<int>(m.size()) < n) {
+        int gid = dist(gen);
+        if (m.find(gid) == m.end()) {
+            auto& item = items[m.size()];
+            item.gid = gid;
+            m[gid] = &item;
+        }
+    }
+    return m;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(flat_gid_map_empty) {
+    FlatGidMap<Item> index;
+    BOOST_CHECK(index.find(0) == nullptr);
+    index.build({});
+    BOOST_CHECK(index.size() == 0);
+    BOOST_CHECK(index.find(0) == nullptr);
+    BOOST_CHECK(index.find(12) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(flat_gid_map_matches_std_map) {
+    std::vector<Item> items;
+    auto m = make_map(items, 10000, 1000000, 1);
+    FlatGidMap<Item> index;
+    index.build(m);
+    BOOST_CHECK(index.size() == m.size());
+    for (int gid = 0; gid < 1000000; ++gid) {
+        auto it = m.find(gid);
+        Item* expected = (it == m.end()) ? nullptr : it->second;
+        if (index.find(gid) != expected) {
+            BOOST_ERROR("lookup mismatch for gid " << gid);
+            break;
+        }
+    }
+    // consecutive gids, the common case of round robin distributed cells
+    std::map<int, Item*> consecutive;
+    for (auto& item: items) {
+        consecutive[static_cast<int>(consecutive.size())] = &item;
+    }
+    index.build(consecutive);
+    for (const auto& kv: consecutive) {
+        BOOST_CHECK(index.find(kv.first) == kv.second);
+    }
+    BOOST_CHECK(index.find(static_cast<int>(consecutive.size())) == nullptr);
+    index.clear();
+    BOOST_CHECK(index.find(0) == nullptr);
+}
+
+// Lookup throughput of std::map and FlatGidMap for a typical receive pattern in
+// which most received gids are not wanted on this rank. Disabled by default, run
+// it with --run_test=flat_gid_map_benchmark --log_level=message
+BOOST_AUTO_TEST_CASE(flat_gid_map_benchmark, *boost::unit_test::disabled()) {
+    const int range = 4'000'000;
+    std::vector<Item> items;
+    auto m = make_map(items, 200'000, range, 2);
+    FlatGidMap<Item> index;
+    index.build(m);
+
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> dist(0, range - 1);
+    std::vector<int> received(2'000'000);
+    for (auto& gid: received) {
+        gid = dist(gen);
+    }
+
+    using clock = std::chrono::steady_clock;
+    std::size_t nfound_map = 0;
+    auto t0 = clock::now();
+    for (int gid: received) {
+        auto it = m.find(gid);
+        if (it != m.end()) {
+            nfound_map += it->second->gid == gid;
+        }
+    }
+    auto t1 = clock::now();
+    std::size_t nfound_index = 0;
+    for (int gid: received) {
+        Item* item = index.find(gid);
+        if (item) {
+            nfound_index += item->gid == gid;
+        }
+    }
+    auto t2 = clock::now();
+    BOOST_CHECK(nfound_map == nfound_index);
+
+    double s_map = std::chrono::duration<double>(t1 - t0).count();
+    double s_index = std::chrono::duration<double>(t2 - t1).count();
+    BOOST_TEST_MESSAGE("gid lookups/s std::map: " << received.size() / s_map << " FlatGidMap: "
+                                                  << received.size() / s_index << " (table bytes "
+                                                  << index.nbytes() << ")");
+}
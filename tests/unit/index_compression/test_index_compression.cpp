@@ -0,0 +1,104 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+#include "coreneuron/apps/corenrn_parameters.hpp"
+#include "coreneuron/coreneuron.hpp"
+#include "coreneuron/mechanism/index_compression.hpp"
+#include "coreneuron/mechanism/membfunc.hpp"
+#include "coreneuron/sim/multicore.hpp"
+
+#define BOOST_TEST_MODULE IndexCompression
+#include <boost/test/included/unit_test.hpp>
+
+#include <vector>
+
+using namespace coreneuron;
+
+namespace {
+// capacitance on every other node of a thread with nnode nodes
+struct CapThread {
+    NrnThread nt;
+    Memb_list ml;
+    std::vector<double> d, rhs, data;
+
+    explicit CapThread(int nnode) {
+        d.assign(nnode, 0.);
+        rhs.resize(nnode);
+        for (int i = 0; i < nnode; ++i) {
+            rhs[i] = 0.5 + i % 7;
+        }
+        nt.end = nnode;
+        nt.cj = 2. / 0.025;
+        nt._actual_d = d.data();
+        nt._actual_rhs = rhs.data();
+        ml.nodecount = nnode / 2;
+        ml._nodecount_padded = ml.nodecount;
+        data.resize(2 * ml.nodecount);
+        for (int i = 0; i < ml.nodecount; ++i) {
+            data[i] = 1. + 0.01 * i;  // cm
+        }
+        ml.data = data.data();
+        ml.nodeindices = static_cast<int*>(emalloc_align(ml.nodecount * sizeof(int)));
+        for (int i = 0; i < ml.nodecount; ++i) {
+            ml.nodeindices[i] = nnode - 1 - 2 * i;
+        }
+    }
+    ~CapThread() {
+        free_memory(ml.nodeindices);
+        nrn_free_compressed_indices(&ml);
+    }
+    void step() {
+        nrn_jacob_capacitance(&nt, &ml, CAP);
+        nrn_cur_capacitance(&nt, &ml, CAP);
+    }
+};
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(capacitance_kernels) {
+    CapThread plain(1000), compressed(1000);
+    nrn_compress_indices(&compressed.ml, CAP);
+    BOOST_CHECK(compressed.ml.nodeindices == nullptr);
+    BOOST_REQUIRE(compressed.ml.nodeindices16 != nullptr);
+    for (int i = 0; i < plain.ml.nodecount; ++i) {
+        BOOST_CHECK_EQUAL(nrn_nodeindex(&compressed.ml, i), nrn_nodeindex(&plain.ml, i));
+    }
+    plain.step();
+    compressed.step();
+    BOOST_CHECK(plain.d == compressed.d);
+    BOOST_CHECK(plain.data == compressed.data);
+
+    // node indices above 65535 stay int
+    CapThread large(2 << 16);
+    nrn_compress_indices(&large.ml, CAP);
+    BOOST_CHECK(large.ml.nodeindices != nullptr);
+    BOOST_CHECK(large.ml.nodeindices16 == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(netcon_indices) {
+    corenrn_param.index_compression = true;
+    NrnThread nt;
+    nt.n_netcon = 5;
+    std::vector<int> target{3, -1, 0, 65534, 7};
+    std::vector<int> weight_index{0, 1, 2, 65535, 70000};
+    nt.netcon_target = static_cast<int*>(emalloc_align(nt.n_netcon * sizeof(int)));
+    nt.netcon_weight_index = static_cast<int*>(emalloc_align(nt.n_netcon * sizeof(int)));
+    std::copy(target.begin(), target.end(), nt.netcon_target);
+    std::copy(weight_index.begin(), weight_index.end(), nt.netcon_weight_index);
+    nrn_compress_indices(&nt);
+    // the -1 sentinel needs 65535, so 65534 is the largest compressible target
+    BOOST_CHECK(nt.netcon_target == nullptr);
+    BOOST_CHECK(nt.netcon_target16 != nullptr);
+    BOOST_CHECK(nt.netcon_weight_index != nullptr);
+    BOOST_CHECK(nt.netcon_weight_index16 == nullptr);
+    for (int i = 0; i < nt.n_netcon; ++i) {
+        BOOST_CHECK_EQUAL(nrn_netcon_target(&nt, i), target[i]);
+        BOOST_CHECK_EQUAL(nrn_netcon_weight_index(&nt, i), weight_index[i]);
+    }
+    free_memory(nt.netcon_weight_index);
+    nrn_free_compressed_indices(&nt);
+    corenrn_param.index_compression = false;
+}
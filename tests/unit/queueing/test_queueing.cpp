@@ -73,6 +73,34 @@ BOOST_AUTO_TEST_CASE(tqueue_ordered_test) {
     BOOST_CHECK(tq.least() == NULL);
 }
 
+template <container C>
+void check_for_each_ordered() {
+    TQueue<C> tq;
+    const size_t num = 100;
+    for (size_t i = 0; i < num; ++i) {
+        tq.insert(static_cast<double>(rand() % num), NULL);
+    }
+    std::vector<TQItem*> visited;
+    tq.for_each_ordered([&](TQItem* q) { visited.push_back(q); });
+    BOOST_CHECK(visited.size() == num);
+
+    // the queue is unchanged and dequeues the items in the same order
+    TQItem* item = NULL;
+    size_t i = 0;
+    while ((item = tq.atomic_dq(1e20)) != NULL) {
+        BOOST_REQUIRE(i < visited.size());
+        BOOST_CHECK(item == visited[i]);
+        ++i;
+        delete item;
+    }
+    BOOST_CHECK(i == num);
+}
+
+BOOST_AUTO_TEST_CASE(tqueue_for_each_ordered) {
+    check_for_each_ordered<spltree>();
+    check_for_each_ordered<pq_que>();
+}
+
 BOOST_AUTO_TEST_CASE(tqueue_move_nolock) {}
 
 BOOST_AUTO_TEST_CASE(tqueue_remove) {}
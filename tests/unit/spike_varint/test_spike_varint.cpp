@@ -0,0 +1,78 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+#include "coreneuron/network/spike_varint.hpp"
+
+#define BOOST_TEST_MODULE SpikeVarint
+#include <boost/test/included/unit_test.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace coreneuron;
+
+BOOST_AUTO_TEST_CASE(varint_roundtrip) {
+    std::vector<std::uint32_t> values{0, 1, 127, 128, 255, 16383, 16384, 0x7fffffff, 0xffffffff};
+    std::vector<unsigned char> buf(values.size() * spike_varint::max_varint_bytes);
+    unsigned char* p = buf.data();
+    for (auto v: values) {
+        p = spike_varint::put(p, v);
+    }
+    const unsigned char* q = buf.data();
+    for (auto v: values) {
+        std::uint32_t w;
+        q = spike_varint::get(q, w);
+        BOOST_CHECK_EQUAL(v, w);
+    }
+    BOOST_CHECK(q == p);
+    for (std::int32_t v: {0, 1, -1, 2, -2, 1000, -1000, INT32_MAX, INT32_MIN}) {
+        BOOST_CHECK_EQUAL(spike_varint::unzigzag(spike_varint::zigzag(v)), v);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(spike_roundtrip) {
+    const double dt = 0.025;
+    const double t0 = 12.5;
+    // min delays far beyond the 255 dt of the fixed size compression
+    const int nstep = 4000;
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> gid_dist(0, 1'000'000);
+    std::uniform_int_distribution<int> step_dist(0, nstep);
+    std::vector<NRNMPI_Spike> spikes(1000);
+    for (auto& spike: spikes) {
+        spike.gid = gid_dist(gen);
+        spike.spiketime = t0 + step_dist(gen) * dt + 1e-10;
+    }
+    // same gid firing several times in one interval
+    spikes[1].gid = spikes[0].gid;
+    spikes[2].gid = spikes[0].gid;
+
+    std::vector<unsigned char> buf;
+    std::size_t nbytes = spike_varint::encode(spikes.data(), spikes.size(), t0, 1. / dt, buf);
+    BOOST_CHECK_EQUAL(nbytes, buf.size());
+    BOOST_CHECK(nbytes < spikes.size() * 8);
+    for (std::size_t i = 1; i < spikes.size(); ++i) {
+        BOOST_CHECK(spikes[i - 1].gid <= spikes[i].gid);
+    }
+
+    std::vector<NRNMPI_Spike> decoded(nbytes / spike_varint::min_spike_bytes);
+    int n = spike_varint::decode(buf.data(), nbytes, t0, dt, decoded.data());
+    BOOST_REQUIRE_EQUAL(n, static_cast<int>(spikes.size()));
+    for (int i = 0; i < n; ++i) {
+        BOOST_CHECK_EQUAL(decoded[i].gid, spikes[i].gid);
+        BOOST_CHECK(std::fabs(decoded[i].spiketime - spikes[i].spiketime) < 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(spike_empty) {
+    std::vector<unsigned char> buf;
+    BOOST_CHECK_EQUAL(spike_varint::encode(nullptr, 0, 0., 40., buf), 0);
+    NRNMPI_Spike out;
+    BOOST_CHECK_EQUAL(spike_varint::decode(buf.data(), 0, 0., 0.025, &out), 0);
+}
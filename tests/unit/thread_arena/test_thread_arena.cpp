@@ -0,0 +1,128 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+#include "coreneuron/utils/memory.h"
+#include "coreneuron/utils/thread_arena.hpp"
+
+#define BOOST_TEST_MODULE ThreadArena
+#include <boost/test/included/unit_test.hpp>
+
+#include <vector>
+
+using namespace coreneuron;
+
+BOOST_AUTO_TEST_CASE(bump_arena_allocate) {
+    BumpArena arena;
+    BOOST_CHECK(arena.nchunk() == 0);
+    std::vector<char*> ps;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        auto p = static_cast<char*>(arena.allocate(i * 37 + 1, 64));
+        BOOST_CHECK(is_aligned(p, 64));
+        p[i * 37] = 1;
+        ps.push_back(p);
+    }
+    // allocations do not overlap
+    for (std::size_t i = 1; i < ps.size(); ++i) {
+        BOOST_CHECK(ps[i] >= ps[i - 1] + (i - 1) * 37 + 1 || ps[i] < ps[i - 1]);
+    }
+    // larger than any chunk
+    auto big = static_cast<char*>(arena.allocate(std::size_t(100) << 20, 16));
+    big[(std::size_t(100) << 20) - 1] = 1;
+    BOOST_CHECK(arena.nbytes_used() >= std::size_t(100) << 20);
+    BOOST_CHECK(arena.nbytes_reserved() >= arena.nbytes_used());
+    arena.release();
+    BOOST_CHECK(arena.nchunk() == 0);
+    BOOST_CHECK(arena.nbytes_used() == 0);
+}
+
+#ifndef CORENEURON_UNIFIED_MEMORY
+BOOST_AUTO_TEST_CASE(thread_arena_scope) {
+    nrn_thread_arenas_create(2);
+    std::vector<void*> ps;
+    {
+        NrnThreadArenaScope scope(1);
+        for (int i = 0; i < 100; ++i) {
+            ps.push_back(ecalloc_align(i + 1, sizeof(double)));
+            ps.push_back(emalloc_align(i + 1, 0));
+        }
+    }
+    void* heap = ecalloc_align(10, sizeof(double));
+    for (void* p: ps) {
+        BOOST_CHECK(nrn_arena_owns(p));
+    }
+    BOOST_CHECK(!nrn_arena_owns(heap));
+    BOOST_CHECK(static_cast<double*>(ps[0])[0] == 0.0);
+    // free_memory leaves arena memory alone
+    for (void* p: ps) {
+        free_memory(p);
+    }
+    free_memory(heap);
+    nrn_thread_arenas_free();
+}
+
+BOOST_AUTO_TEST_CASE(thread_arena_free) {
+    nrn_thread_arenas_create(1);
+    {
+        NrnThreadArenaScope scope(0);
+        // a temporary on top of the open chunk is popped
+        void* keep = emalloc_align(1000);
+        void* tmp = emalloc_align(5000);
+        free_memory(tmp);
+        BOOST_CHECK(emalloc_align(5000) == tmp);
+        // one below the top is reused by an allocation of similar size
+        void* top = emalloc_align(100);
+        free_memory(tmp);
+        BOOST_CHECK(ecalloc_align(4000, 1) == tmp);
+        BOOST_CHECK(static_cast<char*>(tmp)[3999] == 0);
+        // too large to reuse the block
+        void* other = emalloc_align(20000);
+        BOOST_CHECK(other != tmp);
+        for (void* p: {keep, top, other, tmp}) {
+            BOOST_CHECK(nrn_arena_owns(p));
+        }
+    }
+    nrn_thread_arenas_free();
+}
+
+BOOST_AUTO_TEST_CASE(huge_page_allocations) {
+    for (int mode: {1, 2}) {
+        nrn_huge_pages_init(mode);
+        // small arrays stay on the heap
+        void* small = emalloc_align(1000);
+        BOOST_CHECK(!nrn_huge_free(small));
+        free_memory(small);
+        std::size_t n = 3 * huge_page_size / sizeof(double) + 5;
+        auto big = static_cast<double*>(ecalloc_align(n, sizeof(double)));
+        BOOST_CHECK(is_aligned(big, huge_page_size));
+        BOOST_CHECK(big[n - 1] == 0.0);
+        big[n - 1] = 1.0;
+        std::size_t nhugetlb, ntransparent;
+        nrn_huge_pages_count(nhugetlb, ntransparent);
+        // whether pages are obtained depends on the system, not more than mapped
+        BOOST_CHECK(nhugetlb + ntransparent <= 4);
+        free_memory(big);
+        BOOST_CHECK(!nrn_huge_free(big));
+    }
+    // the first, small chunk of an arena is a huge page as well
+    nrn_huge_pages_init(1);
+    {
+        BumpArena arena;
+        void* p = arena.allocate(1000, 64);
+        BOOST_CHECK(is_aligned(p, huge_page_size));
+        BOOST_CHECK(arena.nbytes_reserved() == huge_page_size);
+    }
+    nrn_huge_pages_init(0);
+    {
+        BumpArena arena;
+        arena.allocate(1000, 64);
+        BOOST_CHECK(arena.nbytes_reserved() < huge_page_size);
+    }
+    void* big = emalloc_align(4 * huge_page_size);
+    BOOST_CHECK(!nrn_huge_free(big));
+    free_memory(big);
+}
+#endif
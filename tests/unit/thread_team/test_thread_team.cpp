@@ -0,0 +1,147 @@
+/*
+# =============================================================================
+# Copyright (c) 2016 - 2022 Blue Brain Project/EPFL
+#
+# See top-level LICENSE file for details.
+# =============================================================================.
+*/
+#include "coreneuron/sim/multicore.hpp"
+#include "coreneuron/sim/thread_balance.hpp"
+#include "coreneuron/sim/thread_team.hpp"
+
+#define BOOST_TEST_MODULE ThreadTeam
+#include <boost/test/included/unit_test.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace coreneuron;
+
+namespace {
+// every NrnThread runs every job once, with a team always on the same member
+void check_jobs(int njob, bool team) {
+    // written by the jobs, checked here as Boost.Test is not thread safe
+    std::vector<int> count(nrn_nthread, 0);
+    std::vector<int> moved(nrn_nthread, 0);
+    std::vector<std::thread::id> owner(nrn_nthread);
+    for (int job = 0; job < njob; ++job) {
+        nrn_multithread_job(
+            [&](NrnThread* nt, int add) {
+                count[nt->id] += add;
+                if (job == 0) {
+                    owner[nt->id] = std::this_thread::get_id();
+                }
+                moved[nt->id] += owner[nt->id] != std::this_thread::get_id();
+            },
+            1);
+    }
+    for (int i = 0; i < nrn_nthread; ++i) {
+        BOOST_CHECK_EQUAL(count[i], njob);
+        BOOST_CHECK(!team || moved[i] == 0);
+    }
+    // NrnThread 0 stays on the calling thread
+    BOOST_CHECK(owner[0] == std::this_thread::get_id());
+}
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(thread_team_jobs) {
+    nrn_threads_create(6);
+    int nteam = nrn_thread_team_start(false);
+    BOOST_CHECK(nteam == 0 || nrn_thread_team_active());
+    check_jobs(1000, nteam > 0);
+
+    // a job posted from within a job runs serially
+    std::atomic<int> nested{0};
+    nrn_multithread_job([&](NrnThread*) {
+        nrn_multithread_job([&](NrnThread*) { ++nested; });
+    });
+    BOOST_CHECK_EQUAL(nested.load(), nrn_nthread * nrn_nthread);
+
+    nrn_thread_team_stop();
+    BOOST_CHECK(!nrn_thread_team_active());
+    check_jobs(10, false);
+    nrn_threads_free();
+}
+
+BOOST_AUTO_TEST_CASE(thread_team_assign) {
+    nrn_threads_create(6);
+    int nteam = nrn_thread_team_start(false);
+    if (nteam > 1) {
+        // everything but NrnThread 0 on the last member
+        std::vector<int> member_of(nrn_nthread, nteam - 1);
+        member_of[0] = 0;
+        nrn_thread_team_assign(member_of);
+        BOOST_CHECK(nrn_thread_team_assignment() == member_of);
+        check_jobs(100, true);
+        std::vector<std::thread::id> owner(nrn_nthread);
+        nrn_multithread_job([&](NrnThread* nt) { owner[nt->id] = std::this_thread::get_id(); });
+        for (int i = 2; i < nrn_nthread; ++i) {
+            BOOST_CHECK(owner[i] == owner[1]);
+        }
+        BOOST_CHECK(owner[1] != owner[0]);
+    }
+    nrn_threads_free();
+}
+
+#if defined(__linux__)
+BOOST_AUTO_TEST_CASE(thread_team_pinned) {
+    cpu_set_t before;
+    BOOST_REQUIRE(sched_getaffinity(0, sizeof(before), &before) == 0);
+    nrn_threads_create(4);
+    int nteam = nrn_thread_team_start(true);
+    check_jobs(10, nteam > 0);
+    if (nteam > 1 && CPU_COUNT(&before) > 1) {
+        cpu_set_t pinned;
+        BOOST_REQUIRE(sched_getaffinity(0, sizeof(pinned), &pinned) == 0);
+        BOOST_CHECK(CPU_COUNT(&pinned) == 1);
+    }
+    // the master does not stay pinned after the team
+    nrn_threads_free();
+    cpu_set_t after;
+    BOOST_REQUIRE(sched_getaffinity(0, sizeof(after), &after) == 0);
+    BOOST_CHECK(CPU_EQUAL(&before, &after));
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(thread_balance_lpt) {
+    std::vector<double> cost{1., 8., 1., 1., 5., 2., 2.};
+    // round robin over 3 members: loads 4, 13, 3
+    std::vector<int> round_robin{0, 1, 2, 0, 1, 2, 0};
+    BOOST_CHECK_CLOSE(nrn_thread_imbalance(cost, round_robin, 3), 13. * 3 / 20 - 1., 1e-9);
+    auto member_of = nrn_thread_lpt_assign(cost, 3);
+    BOOST_CHECK_EQUAL(member_of[0], 0);
+    // 8 | 5 + 1 | 1 + 2 + 2 + 1 is the best possible
+    BOOST_CHECK_CLOSE(nrn_thread_imbalance(cost, member_of, 3), 8. * 3 / 20 - 1., 1e-9);
+    // a single expensive NrnThread 0 keeps member 0 for itself
+    std::vector<double> cost0{10., 1., 1., 1.};
+    member_of = nrn_thread_lpt_assign(cost0, 2);
+    BOOST_CHECK(member_of == std::vector<int>({0, 1, 1, 1}));
+    BOOST_CHECK_CLOSE(nrn_thread_imbalance(cost0, member_of, 2), 10. * 2 / 13 - 1., 1e-9);
+    BOOST_CHECK_EQUAL(nrn_thread_imbalance({0., 0.}, {0, 1}, 2), 0.);
+}
+
+BOOST_AUTO_TEST_CASE(thread_balance_lpt_numa) {
+    // members 0, 1 on node 0 and member 2 on node 1
+    std::vector<int> member_node{0, 0, 1};
+    std::vector<double> cost{1., 8., 1., 1., 5., 2., 2.};
+    std::vector<int> thread_node{0, 0, 0, 1, 0, 1, 0};
+    auto member_of = nrn_thread_lpt_assign(cost, member_node, thread_node);
+    BOOST_CHECK_EQUAL(member_of[0], 0);
+    for (std::size_t i = 0; i < cost.size(); ++i) {
+        BOOST_CHECK_EQUAL(member_node[member_of[i]], thread_node[i]);
+    }
+    // node 1 gets 1 + 2 and node 0 splits 8 | 1 + 5 + 2 + 1
+    BOOST_CHECK(member_of == std::vector<int>({0, 1, 0, 2, 0, 2, 0}));
+    // a NrnThread from a node without members may go anywhere
+    member_of = nrn_thread_lpt_assign({1., 1., 1.}, {0, 0}, {0, 1, 2});
+    BOOST_CHECK(member_of == std::vector<int>({0, 1, 0}));
+    // with a single node it is the plain LPT
+    BOOST_CHECK(nrn_thread_lpt_assign(cost, {0, 0, 0}, std::vector<int>(7, 0)) ==
+                nrn_thread_lpt_assign(cost, 3));
+}